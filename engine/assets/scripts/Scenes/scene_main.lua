@@ -36,6 +36,12 @@ scene = {
 
 	-- Maps Table
 	maps = {
+		-- map_path = "./assets/maps/level.tmx",
+		-- tile_path = "./assets/maps/tileset.tsx",
+		-- tile_name = "tileset", -- sprite id of the tileset image
+		-- Solid tiles of a layer named "collision" and sprite-less objects of
+		-- the "colliders" group block bodies without an entity per tile
+		-- tile_collision = true
 	},
 
 	-- Entities Table
@@ -1,4 +1,16 @@
 scenes = {
 	[0] =
 	{name = "main", path = "./assets/scripts/Scenes/main.lua"}
-}
\ No newline at end of file
+}
+
+-- Optional simulation settings, defaults shown
+settings = {
+	tick_rate = 60,
+	max_catch_up_steps = 5,
+	target_fps = 60, -- 0 runs uncapped
+	vsync = false,
+	-- Font of the performance overlay shown in debug mode (i key), the
+	-- built-in 8x8 font of SDL2_gfx is used when it is not set
+	-- hud_font = "./assets/fonts/your_font.ttf",
+	hud_font_size = 14
+}
@@ -0,0 +1,176 @@
+/**
+ * @file CollisionKernelBench.cpp
+ * @brief Microbenchmark comparing the scalar and SIMD collision kernels
+ * @author Juan Torres
+ * @date 2024
+ *
+ * Scatters boxes and circles over a square world, collects candidate pairs
+ * with the BroadphaseGrid and runs every available kernel over the same
+ * pair runs the collision systems use. Results are checked against the
+ * scalar kernel and printed as JSON. Circles only have the scalar kernel,
+ * timed as the baseline of the circle system.
+ *
+ * Usage: collision_bench [colliders] [iterations]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../src/Physics/BroadphaseGrid.hpp"
+#include "../src/Physics/CollisionKernels.hpp"
+
+namespace {
+
+    /** @brief Timing of one kernel over the whole pair list */
+    struct KernelResult {
+        const char* name; /**< Kernel name */
+        double seconds; /**< Best time of all iterations */
+        long long hits; /**< Hits found in one pass */
+        bool matches; /**< Hits identical to the scalar kernel */
+    };
+
+    /**
+     * @brief Runs kernel over every run of pairs sharing the same first proxy.
+     */
+    template <typename Bounds, typename Kernel>
+    long long RunPass(const Bounds& bounds, const std::vector<ProxyPair>& pairs, Kernel kernel,
+        std::vector<int>& candidates, std::vector<int>& hits, std::vector<int>& output) {
+        long long hitCount = 0;
+        output.clear();
+        size_t k = 0;
+        while (k < pairs.size()) {
+            int a = pairs[k].a;
+            candidates.clear();
+            while (k < pairs.size() && pairs[k].a == a) {
+                candidates.push_back(pairs[k].b);
+                k++;
+            }
+            hits.resize(candidates.size());
+            int found = kernel(bounds, a, candidates.data(),
+                static_cast<int>(candidates.size()), hits.data());
+            output.insert(output.end(), hits.begin(), hits.begin() + found);
+            hitCount += found;
+        }
+        return hitCount;
+    }
+
+    /**
+     * @brief Times one kernel and compares its output to the reference.
+     */
+    template <typename Bounds, typename Kernel>
+    KernelResult Measure(const char* name, const Bounds& bounds, const std::vector<ProxyPair>& pairs,
+        Kernel kernel, int iterations, const std::vector<int>& reference) {
+        std::vector<int> candidates;
+        std::vector<int> hits;
+        std::vector<int> output;
+        KernelResult result = { name, 1e30, 0, true };
+
+        for (int i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            result.hits = RunPass(bounds, pairs, kernel, candidates, hits, output);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() < result.seconds) {
+                result.seconds = elapsed.count();
+            }
+        }
+        result.matches = reference.empty() || output == reference;
+        return result;
+    }
+
+    /**
+     * @brief Prints one JSON object per kernel.
+     */
+    void PrintResults(const char* shape, const std::vector<KernelResult>& results, size_t pairCount,
+        bool last) {
+        std::printf("    \"%s\": [\n", shape);
+        for (size_t i = 0; i < results.size(); i++) {
+            const KernelResult& r = results[i];
+            double pairsPerSecond = r.seconds > 0.0 ? pairCount / r.seconds : 0.0;
+            std::printf("      { \"kernel\": \"%s\", \"seconds\": %.6f, \"pairs_per_second\": %.0f, "
+                "\"speedup\": %.2f, \"hits\": %lld, \"matches_scalar\": %s }%s\n",
+                r.name, r.seconds, pairsPerSecond,
+                r.seconds > 0.0 ? results[0].seconds / r.seconds : 0.0,
+                r.hits, r.matches ? "true" : "false", i + 1 < results.size() ? "," : "");
+        }
+        std::printf("    ]%s\n", last ? "" : ",");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int colliderCount = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    // Dense enough that most grid cells hold several colliders
+    float worldSize = 40.0f * std::sqrt(static_cast<float>(colliderCount));
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(0.0f, worldSize);
+    std::uniform_int_distribution<int> size(8, 64);
+
+    std::vector<Aabb> boxBounds;
+    std::vector<Aabb> circleBounds;
+    BoxBoundsSoA boxes;
+    CircleBoundsSoA circles;
+    for (int i = 0; i < colliderCount; i++) {
+        float x = position(rng);
+        float y = position(rng);
+        float w = static_cast<float>(size(rng));
+        float h = static_cast<float>(size(rng));
+        boxes.Push(x, y, x + w, y + h);
+        boxBounds.push_back({ x, y, x + w, y + h });
+
+        int radius = size(rng) / 2;
+        circles.Push(x, y, radius);
+        circleBounds.push_back({ x - radius, y - radius, x + radius, y + radius });
+    }
+
+    BroadphaseGrid broadphase;
+    std::vector<ProxyPair> boxPairs;
+    std::vector<ProxyPair> circlePairs;
+    broadphase.Build(boxBounds);
+    broadphase.FindPairs(boxPairs);
+    broadphase.Build(circleBounds);
+    broadphase.FindPairs(circlePairs);
+
+    std::vector<int> candidates;
+    std::vector<int> hits;
+    std::vector<int> boxReference;
+    std::vector<int> circleReference;
+    RunPass(boxes, boxPairs, CollisionKernels::BoxScalar, candidates, hits, boxReference);
+    RunPass(circles, circlePairs, CollisionKernels::CircleScalar, candidates, hits, circleReference);
+
+    std::vector<KernelResult> boxResults;
+    std::vector<KernelResult> circleResults;
+    boxResults.push_back(Measure("scalar", boxes, boxPairs,
+        CollisionKernels::BoxScalar, iterations, boxReference));
+    circleResults.push_back(Measure("scalar", circles, circlePairs,
+        CollisionKernels::CircleScalar, iterations, circleReference));
+#if COLLISION_KERNELS_X86
+    boxResults.push_back(Measure("sse", boxes, boxPairs,
+        CollisionKernels::BoxSse, iterations, boxReference));
+    if (CollisionKernels::HasAvx2()) {
+        boxResults.push_back(Measure("avx2", boxes, boxPairs,
+            CollisionKernels::BoxAvx2, iterations, boxReference));
+    }
+#endif
+
+    bool allMatch = true;
+    for (const auto& r : boxResults) allMatch = allMatch && r.matches;
+    for (const auto& r : circleResults) allMatch = allMatch && r.matches;
+
+    std::printf("{\n");
+    std::printf("  \"colliders\": %d,\n", colliderCount);
+    std::printf("  \"iterations\": %d,\n", iterations);
+    std::printf("  \"dispatch\": \"%s\",\n", CollisionKernels::GetKernelName());
+    std::printf("  \"box_pairs\": %zu,\n", boxPairs.size());
+    std::printf("  \"circle_pairs\": %zu,\n", circlePairs.size());
+    std::printf("  \"results\": {\n");
+    PrintResults("box", boxResults, boxPairs.size(), false);
+    PrintResults("circle", circleResults, circlePairs.size(), true);
+    std::printf("  }\n");
+    std::printf("}\n");
+
+    return allMatch ? 0 : 1;
+}
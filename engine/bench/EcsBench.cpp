@@ -0,0 +1,353 @@
+/**
+ * @file EcsBench.cpp
+ * @brief Microbenchmarks of the ECS primitives
+ * @author Juan Torres
+ * @date 2024
+ *
+ * Times entity creation and churn, AddComponent, GetComponent, system
+ * iteration, a full MovementSystem::Update against the separate gravity
+ * and movement passes it replaced, Registry::Update with large add and kill
+ * sets and entity replication, for entity counts from 1k to 1M. Every case runs on a fresh
+ * Registry and keeps the best of several runs; only components that do not
+ * need SDL are used, so the bench builds without the SDL headers.
+ * Results are printed as JSON; the registry log is silenced so stdout only
+ * holds the JSON.
+ *
+ * Cases whose cost grows with the square of the entity count (removing
+ * entities from a system scans its whole entity list) are skipped above a
+ * work budget and reported with "skipped": true.
+ *
+ * Usage: ecs_bench [max entities] [repetitions]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../src/Components/BoxColliderComponent.hpp"
+#include "../src/Components/PropertyComponent.hpp"
+#include "../src/Components/RigidBodyComponent.hpp"
+#include "../src/Components/TransformComponent.hpp"
+#include "../src/ECS/ECS.hpp"
+#include "../src/Systems/MovementSystem.hpp"
+
+namespace {
+
+    /** @brief Scanned entities above which a quadratic case is skipped */
+    const double QUADRATIC_BUDGET = 5e9;
+
+    /** @brief System over moving bodies, like the MovementSystem */
+    class BodySystem : public System {
+    public:
+        BodySystem() {
+            RequireComponent<TransformComponent>();
+            RequireComponent<RigidBodyComponent>();
+        }
+    };
+
+    /** @brief Gravity pass of the former PhysicsSystem, the baseline of MovementSystem */
+    class GravityPassSystem : public System {
+    public:
+        GravityPassSystem() {
+            RequireComponent<RigidBodyComponent>();
+            RequireComponent<TransformComponent>();
+        }
+
+        void Update() {
+            for (auto entity : GetSystemEntities()) {
+                auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+                if (rigidbody.isDynamic) {
+                    rigidbody.sumForces += glm::vec2(0.0f, 9.8f * rigidbody.mass * 64);
+                }
+            }
+        }
+    };
+
+    /** @brief Movement pass that followed the gravity pass, the baseline of MovementSystem */
+    class MovementPassSystem : public System {
+    public:
+        MovementPassSystem() {
+            RequireComponent<RigidBodyComponent>();
+            RequireComponent<TransformComponent>();
+        }
+
+        void Update(double dt) {
+            for (auto entity : GetSystemEntities()) {
+                auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+                auto& transform = entity.GetComponent<TransformComponent>();
+
+                transform.previousPosition = transform.position;
+
+                if (rigidbody.isDynamic) {
+                    rigidbody.acceleration = rigidbody.sumForces * rigidbody.invMass;
+                    rigidbody.velocity += rigidbody.acceleration * static_cast<float>(dt);
+                    transform.position += rigidbody.velocity * static_cast<float>(dt);
+                    rigidbody.sumForces = glm::vec2(0);
+                }
+                else {
+                    transform.position.x += rigidbody.velocity.x * dt;
+                    transform.position.y += rigidbody.velocity.y * dt;
+                }
+            }
+        }
+    };
+
+    /** @brief System over every transform, like the render systems */
+    class TransformSystem : public System {
+    public:
+        TransformSystem() {
+            RequireComponent<TransformComponent>();
+        }
+    };
+
+    /** @brief Timing of one case at one entity count */
+    struct CaseResult {
+        std::string name; /**< Case name */
+        int entities; /**< Entity count */
+        int operations; /**< Operations timed per run */
+        double seconds; /**< Best run, negative when skipped */
+        std::string note; /**< Reason the case was skipped */
+    };
+
+    /**
+     * @brief Runs setup then the timed body on a fresh registry, keeping the best time.
+     */
+    double Measure(int repetitions, const std::function<void(Registry&)>& setup,
+        const std::function<void(Registry&)>& body) {
+        double best = 1e30;
+        for (int i = 0; i < repetitions; i++) {
+            Registry registry;
+            registry.AddSystem<BodySystem>();
+            registry.AddSystem<TransformSystem>();
+            setup(registry);
+
+            auto start = std::chrono::steady_clock::now();
+            body(registry);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() < best) {
+                best = elapsed.count();
+            }
+        }
+        return best;
+    }
+
+    /** @brief Creates count entities without components */
+    void CreateBare(Registry& registry, int count, std::vector<Entity>& entities) {
+        entities.clear();
+        for (int i = 0; i < count; i++) {
+            entities.push_back(registry.CreateEntity());
+        }
+    }
+
+    /** @brief Creates count bodies with a transform and a rigid body */
+    void CreateBodies(Registry& registry, int count, std::vector<Entity>& entities) {
+        CreateBare(registry, count, entities);
+        for (int i = 0; i < count; i++) {
+            registry.AddComponent<TransformComponent>(entities[i], glm::vec2(i, i));
+            registry.AddComponent<RigidBodyComponent>(entities[i], true, false, 1.0f);
+        }
+    }
+
+    /**
+     * @brief Copies every component of a prototype, as SceneLoader::ReplicateEntity does.
+     *
+     * The sprite ReplicateEntity also copies is left out, as SpriteComponent
+     * needs SDL.
+     */
+    void Replicate(Registry& registry, Entity prototype, float x, float y) {
+        Entity copy = registry.CreateEntity();
+        PropertyComponent property = registry.GetComponent<PropertyComponent>(prototype);
+        property.tag = "Replicated";
+        registry.AddComponent<PropertyComponent>(copy, property);
+        registry.AddComponent<BoxColliderComponent>(copy,
+            registry.GetComponent<BoxColliderComponent>(prototype));
+        registry.AddComponent<RigidBodyComponent>(copy,
+            registry.GetComponent<RigidBodyComponent>(prototype));
+        const auto transform = registry.GetComponent<TransformComponent>(prototype);
+        registry.AddComponent<TransformComponent>(copy, glm::vec2(x, y), transform.scale,
+            transform.rotation, transform.cameraFree);
+    }
+
+    /**
+     * @brief Runs every case for one entity count.
+     */
+    void RunCases(int count, int repetitions, std::vector<CaseResult>& results) {
+        std::vector<Entity> entities;
+        double sink = 0.0;
+
+        results.push_back({ "create_entity", count, count, Measure(repetitions,
+            [](Registry&) {},
+            [&](Registry& registry) {
+                CreateBare(registry, count, entities);
+                registry.Update();
+            }), "" });
+
+        // Kill everything and create it again; bare entities join no system
+        results.push_back({ "entity_churn", count, count * 2, Measure(repetitions,
+            [&](Registry& registry) {
+                CreateBare(registry, count, entities);
+                registry.Update();
+            },
+            [&](Registry& registry) {
+                for (auto entity : entities) {
+                    registry.KillEntity(entity);
+                }
+                registry.Update();
+                CreateBare(registry, count, entities);
+                registry.Update();
+            }), "" });
+
+        results.push_back({ "add_component", count, count * 2, Measure(repetitions,
+            [&](Registry& registry) {
+                CreateBare(registry, count, entities);
+            },
+            [&](Registry& registry) {
+                for (int i = 0; i < count; i++) {
+                    registry.AddComponent<TransformComponent>(entities[i], glm::vec2(i, i));
+                    registry.AddComponent<RigidBodyComponent>(entities[i], true, false, 1.0f);
+                }
+            }), "" });
+
+        results.push_back({ "get_component", count, count * 2, Measure(repetitions,
+            [&](Registry& registry) {
+                CreateBodies(registry, count, entities);
+            },
+            [&](Registry& registry) {
+                for (auto entity : entities) {
+                    sink += registry.GetComponent<TransformComponent>(entity).position.x;
+                    sink += registry.GetComponent<RigidBodyComponent>(entity).invMass;
+                }
+            }), "" });
+
+        results.push_back({ "registry_update_add", count, count, Measure(repetitions,
+            [&](Registry& registry) {
+                CreateBodies(registry, count, entities);
+            },
+            [&](Registry& registry) {
+                registry.Update();
+            }), "" });
+
+        // Integrate every body the way the MovementSystem walks its entities
+        results.push_back({ "system_iteration", count, count, Measure(repetitions,
+            [&](Registry& registry) {
+                CreateBodies(registry, count, entities);
+                registry.Update();
+            },
+            [&](Registry& registry) {
+                for (auto entity : registry.GetSystem<BodySystem>().GetSystemEntities()) {
+                    auto& transform = registry.GetComponent<TransformComponent>(entity);
+                    const auto& rigidBody = registry.GetComponent<RigidBodyComponent>(entity);
+                    transform.position += rigidBody.velocity * (1.0f / 60.0f);
+                    sink += transform.position.x;
+                }
+            }), "" });
+
+        // Both movement cases run one untimed step first, so they time a steady state
+        results.push_back({ "movement_update", count, count, Measure(repetitions,
+            [&](Registry& registry) {
+                registry.AddSystem<MovementSystem>();
+                CreateBodies(registry, count, entities);
+                registry.Update();
+                registry.GetSystem<MovementSystem>().Update(1.0 / 60.0);
+            },
+            [&](Registry& registry) {
+                registry.GetSystem<MovementSystem>().Update(1.0 / 60.0);
+            }), "" });
+
+        // The same step as separate gravity and movement passes
+        results.push_back({ "movement_two_pass", count, count, Measure(repetitions,
+            [&](Registry& registry) {
+                registry.AddSystem<GravityPassSystem>();
+                registry.AddSystem<MovementPassSystem>();
+                CreateBodies(registry, count, entities);
+                registry.Update();
+                registry.GetSystem<GravityPassSystem>().Update();
+                registry.GetSystem<MovementPassSystem>().Update(1.0 / 60.0);
+            },
+            [&](Registry& registry) {
+                registry.GetSystem<GravityPassSystem>().Update();
+                registry.GetSystem<MovementPassSystem>().Update(1.0 / 60.0);
+            }), "" });
+
+        // A tenth of the bodies die; each removal scans both systems twice
+        int killCount = count / 10;
+        double scanned = static_cast<double>(killCount) * count * 2.0 * 2.0;
+        if (scanned > QUADRATIC_BUDGET) {
+            results.push_back({ "registry_update_kill", count, killCount, -1.0,
+                "System::RemoveEntityFromSystem is linear in the system size" });
+        }
+        else {
+            results.push_back({ "registry_update_kill", count, killCount, Measure(repetitions,
+                [&](Registry& registry) {
+                    CreateBodies(registry, count, entities);
+                    registry.Update();
+                },
+                [&](Registry& registry) {
+                    for (int i = 0; i < killCount; i++) {
+                        registry.KillEntity(entities[i * 10]);
+                    }
+                    registry.Update();
+                }), "" });
+        }
+
+        results.push_back({ "replicate_entity", count, count, Measure(repetitions,
+            [&](Registry&) {},
+            [&](Registry& registry) {
+                Entity prototype = registry.CreateEntity();
+                registry.AddComponent<PropertyComponent>(prototype, "Factory");
+                registry.AddComponent<BoxColliderComponent>(prototype, 32, 32);
+                registry.AddComponent<RigidBodyComponent>(prototype, true, true, 1.0f);
+                registry.AddComponent<TransformComponent>(prototype);
+                for (int i = 0; i < count; i++) {
+                    Replicate(registry, prototype, static_cast<float>(i), 0.0f);
+                }
+                registry.Update();
+            }), "" });
+
+        // Keeps the reads from being optimized away
+        if (sink == 0.123) {
+            std::fprintf(stderr, "%f\n", sink);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int maxEntities = argc > 1 ? std::atoi(argv[1]) : 1000000;
+    int repetitions = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    // The registry logs to std::cout; only the JSON goes to stdout
+    std::ofstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+
+    std::vector<CaseResult> results;
+    for (int count = 1000; count <= maxEntities; count *= 10) {
+        RunCases(count, repetitions, results);
+    }
+    std::cout.rdbuf(console);
+
+    std::printf("{\n");
+    std::printf("  \"benchmark\": \"ecs\",\n");
+    std::printf("  \"repetitions\": %d,\n", repetitions);
+    std::printf("  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const CaseResult& r = results[i];
+        const char* separator = i + 1 < results.size() ? "," : "";
+        if (r.seconds < 0.0) {
+            std::printf("    { \"case\": \"%s\", \"entities\": %d, \"skipped\": true, "
+                "\"reason\": \"%s\" }%s\n", r.name.c_str(), r.entities, r.note.c_str(), separator);
+            continue;
+        }
+        double nsPerOperation = r.operations > 0 ? r.seconds * 1e9 / r.operations : 0.0;
+        std::printf("    { \"case\": \"%s\", \"entities\": %d, \"operations\": %d, "
+            "\"seconds\": %.6f, \"ns_per_op\": %.2f }%s\n",
+            r.name.c_str(), r.entities, r.operations, r.seconds, nsPerOperation, separator);
+    }
+    std::printf("  ]\n");
+    std::printf("}\n");
+
+    return 0;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file EventQueueBench.cpp
+ * @brief Determinism check and timing of the concurrent event queues
+ * @author Juan Torres
+ * @date 2024
+ *
+ * JobPool chunks push keyed events to two EventQueues with PushConcurrent,
+ * the way a parallel system would, and DispatchQueued merges them. Every
+ * frame the merged order is compared with the order a single thread
+ * produces when it walks the items in sequence, so the result must not
+ * depend on which worker ran which chunk. The same pushes are also timed
+ * against a mutex guarded vector sorted by chunk, the simplest locking
+ * alternative. Results are printed as JSON, the EventManager log is
+ * silenced so stdout only holds the JSON, and the exit code is 1 if any
+ * frame differs from the reference.
+ *
+ * Usage: event_bench [items] [frames]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "../src/EventManager/EventManager.hpp"
+#include "../src/Utils/JobPool.hpp"
+
+namespace {
+
+    /** @brief Minimum items per JobPool chunk, small so many chunks race */
+    const int GRAIN = 64;
+
+    /** @brief Event pushed for most items */
+    struct ProbeEvent : public Event {
+        int item; /**< Item that pushed the event */
+        int copy; /**< Index among the events of the item */
+
+        ProbeEvent(int item, int copy) : item(item), copy(copy) {}
+    };
+
+    /** @brief Event pushed for some items, to a second queue */
+    struct EchoEvent : public Event {
+        int item; /**< Item that pushed the event */
+
+        EchoEvent(int item) : item(item) {}
+    };
+
+    /** @brief Spreads the item index so neighbouring items do different work */
+    uint32_t Hash(uint32_t value) {
+        value ^= value >> 16;
+        value *= 0x7feb352dU;
+        value ^= value >> 15;
+        value *= 0x846ca68bU;
+        value ^= value >> 16;
+        return value;
+    }
+
+    /** @brief Number of ProbeEvents an item pushes, 0 to 2 */
+    int ProbeCount(int item) {
+        return static_cast<int>(Hash(static_cast<uint32_t>(item)) % 3);
+    }
+
+    /** @brief Whether an item also pushes an EchoEvent */
+    bool HasEcho(int item) {
+        return Hash(static_cast<uint32_t>(item) + 0x9e3779b9U) % 4 == 0;
+    }
+
+    /** @brief Keeps a few cycles of uneven work per item so chunks finish out of order */
+    uint32_t Work(int item) {
+        uint32_t value = static_cast<uint32_t>(item);
+        int rounds = static_cast<int>(Hash(value) % 64);
+        for (int i = 0; i < rounds; i++) {
+            value = Hash(value);
+        }
+        return value;
+    }
+
+    /** @brief Records the order in which the batches arrive */
+    class Recorder {
+    public:
+        std::vector<int64_t> probes; /**< item * 4 + copy of every ProbeEvent */
+        std::vector<int> echoes; /**< item of every EchoEvent */
+
+        void OnProbes(const EventSpan<ProbeEvent>& events) {
+            for (const ProbeEvent& event : events) {
+                probes.push_back(static_cast<int64_t>(event.item) * 4 + event.copy);
+            }
+        }
+
+        void OnEchoes(const EventSpan<EchoEvent>& events) {
+            for (const EchoEvent& event : events) {
+                echoes.push_back(event.item);
+            }
+        }
+    };
+
+    /** @brief Event staged by the locking baseline */
+    template <typename TEvent>
+    struct LockedEvent {
+        int chunk; /**< Chunk that pushed it */
+        int sequence; /**< Push order within the chunk */
+        TEvent event; /**< The event */
+    };
+
+    /** @brief Events of one type pushed under a lock, the baseline of PushConcurrent */
+    template <typename TEvent>
+    struct LockedQueue {
+        std::mutex mutex; /**< Taken by every push */
+        std::vector<LockedEvent<TEvent>> events; /**< Events in push order */
+        std::vector<int> chunkPushes; /**< Events pushed by every chunk */
+
+        /** @brief Empties the queue for a loop of a number of chunks */
+        void Reset(int chunks) {
+            events.clear();
+            chunkPushes.assign(chunks, 0);
+        }
+
+        template <typename ...TArgs>
+        void Push(int chunk, TArgs&& ... args) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back({ chunk, chunkPushes[chunk]++, TEvent(std::forward<TArgs>(args)...) });
+        }
+
+        /** @brief Orders the events by chunk as the EventQueue merge does */
+        void Sort() {
+            std::sort(events.begin(), events.end(),
+                [](const LockedEvent<TEvent>& a, const LockedEvent<TEvent>& b) {
+                    return a.chunk != b.chunk ? a.chunk < b.chunk : a.sequence < b.sequence;
+                });
+        }
+    };
+
+    /** @brief Runs the pushes of one item, whatever the queues are */
+    template <typename TPushProbe, typename TPushEcho>
+    void PushItem(int item, std::vector<uint32_t>& sink, TPushProbe pushProbe, TPushEcho pushEcho) {
+        sink[item] = Work(item);
+        for (int copy = 0; copy < ProbeCount(item); copy++) {
+            pushProbe(item, copy);
+        }
+        if (HasEcho(item)) {
+            pushEcho(item);
+        }
+    }
+
+    /**
+     * @brief Pushes through PushConcurrent and checks every frame against the reference.
+     * @return Number of frames whose merged order differs from the reference.
+     */
+    int RunConcurrent(int items, int frames, const std::vector<int64_t>& expectedProbes,
+        const std::vector<int>& expectedEchoes, double& best) {
+        JobPool& pool = JobPool::GetInstance();
+        EventManager eventManager;
+        Recorder recorder;
+        eventManager.SubscribeToBatch<ProbeEvent>(&recorder, &Recorder::OnProbes);
+        eventManager.SubscribeToBatch<EchoEvent>(&recorder, &Recorder::OnEchoes);
+        EventQueue<ProbeEvent>& probeQueue = eventManager.GetConcurrentQueue<ProbeEvent>();
+        EventQueue<EchoEvent>& echoQueue = eventManager.GetConcurrentQueue<EchoEvent>();
+
+        std::vector<uint32_t> sink(items);
+        int mismatches = 0;
+        best = 1e30;
+        for (int frame = 0; frame < frames; frame++) {
+            recorder.probes.clear();
+            recorder.echoes.clear();
+            // Events queued by the main thread come before the merged ones
+            eventManager.QueueEvent<ProbeEvent>(-1, 0);
+
+            auto start = std::chrono::steady_clock::now();
+            pool.ParallelFor(items, GRAIN, [&](int chunk, int begin, int end) {
+                for (int item = begin; item < end; item++) {
+                    PushItem(item, sink,
+                        [&](int probe, int copy) { probeQueue.PushConcurrent(chunk, probe, copy); },
+                        [&](int echo) { echoQueue.PushConcurrent(chunk, echo); });
+                }
+            });
+            eventManager.DispatchQueued();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+
+            if (recorder.probes != expectedProbes || recorder.echoes != expectedEchoes) {
+                mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+    /**
+     * @brief Times the same pushes through locked vectors sorted afterwards.
+     * @return Best time of all frames in seconds.
+     */
+    double RunLocked(int items, int frames) {
+        JobPool& pool = JobPool::GetInstance();
+        LockedQueue<ProbeEvent> probeQueue;
+        LockedQueue<EchoEvent> echoQueue;
+        std::vector<uint32_t> sink(items);
+        double best = 1e30;
+        for (int frame = 0; frame < frames; frame++) {
+            probeQueue.Reset(pool.GetChunkCount(items, GRAIN));
+            echoQueue.Reset(pool.GetChunkCount(items, GRAIN));
+
+            auto start = std::chrono::steady_clock::now();
+            pool.ParallelFor(items, GRAIN, [&](int chunk, int begin, int end) {
+                for (int item = begin; item < end; item++) {
+                    PushItem(item, sink,
+                        [&](int probe, int copy) { probeQueue.Push(chunk, probe, copy); },
+                        [&](int echo) { echoQueue.Push(chunk, echo); });
+                }
+            });
+            probeQueue.Sort();
+            echoQueue.Sort();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int items = argc > 1 ? std::atoi(argv[1]) : 200000;
+    int frames = argc > 2 ? std::atoi(argv[2]) : 50;
+    JobPool& pool = JobPool::GetInstance();
+
+    // A single thread walking the items in order gives the reference order
+    std::vector<int64_t> expectedProbes;
+    std::vector<int> expectedEchoes;
+    expectedProbes.push_back(-4);
+    for (int item = 0; item < items; item++) {
+        for (int copy = 0; copy < ProbeCount(item); copy++) {
+            expectedProbes.push_back(static_cast<int64_t>(item) * 4 + copy);
+        }
+        if (HasEcho(item)) {
+            expectedEchoes.push_back(item);
+        }
+    }
+
+    // The EventManager logs to std::cout; only the JSON goes to stdout
+    std::ofstream discard;
+    std::streambuf* console = std::cout.rdbuf(discard.rdbuf());
+    double bestConcurrent = 0.0;
+    int mismatches = RunConcurrent(items, frames, expectedProbes, expectedEchoes, bestConcurrent);
+    std::cout.rdbuf(console);
+    double bestLocked = RunLocked(items, frames);
+
+    std::printf("{\n");
+    std::printf("  \"items\": %d,\n", items);
+    std::printf("  \"frames\": %d,\n", frames);
+    std::printf("  \"threads\": %d,\n", pool.GetThreadCount());
+    std::printf("  \"chunks\": %d,\n", pool.GetChunkCount(items, GRAIN));
+    std::printf("  \"events_per_frame\": %zu,\n", expectedProbes.size() + expectedEchoes.size());
+    std::printf("  \"mismatched_frames\": %d,\n", mismatches);
+    std::printf("  \"concurrent_ms\": %.3f,\n", bestConcurrent * 1000.0);
+    std::printf("  \"locked_ms\": %.3f\n", bestLocked * 1000.0);
+    std::printf("}\n");
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+"""Scene benchmark harness.
+
+Generates parametric stress scenes in the assets/scripts/Scenes format, runs
+each one headless for a fixed number of frames and collects the statistics
+written by the engine with --stats-json: load time, frame time percentiles,
+peak resident memory and the mean time of every system.
+
+Scenes:
+- sprites: N entities with a transform and a sprite
+- boxes: N dynamic box colliders packed in a grid
+- scripts: N entities running a Lua update every frame
+- tilemap: a Tiled map of S x S tiles with a collision layer
+- objects: K 3D objects
+
+Headless runs skip the render systems, so only the simulation systems are
+timed; sprites and 3D objects still pay their load and ECS cost.
+
+Usage, from the engine folder after make:
+    python3 bench/scene_bench.py --output scene_bench.json
+    python3 bench/scene_bench.py --write-baseline bench/scene_baseline.json
+    python3 bench/scene_bench.py --baseline bench/scene_baseline.json --threshold 0.15
+
+With --baseline the run exits with status 1 when any tracked metric is
+slower than the baseline by more than the threshold.
+"""
+
+import argparse
+import json
+import os
+import struct
+import subprocess
+import sys
+import zlib
+
+GENERATED = os.path.join("bench", "generated")
+TILE_SIZE = 32
+TILESET_COLUMNS = 8
+
+# Differences under these floors are noise, whatever the ratio
+FLOOR_MS = 0.05
+FLOOR_MEMORY_KB = 1024
+
+
+def write(path, text):
+    with open(path, "w") as file:
+        file.write(text)
+
+
+def write_png(path, width, height):
+    """Writes a solid white RGBA PNG, only read by windowed runs."""
+    row = b"\x00" + b"\xff" * (width * 4)
+    raw = row * height
+
+    def chunk(kind, data):
+        body = kind + data
+        return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF)
+
+    header = struct.pack(">IIBBBBB", width, height, 8, 6, 0, 0, 0)
+    with open(path, "wb") as file:
+        file.write(b"\x89PNG\r\n\x1a\n")
+        file.write(chunk(b"IHDR", header))
+        file.write(chunk(b"IDAT", zlib.compress(raw)))
+        file.write(chunk(b"IEND", b""))
+
+
+def write_assets():
+    """Writes the textures, script, tileset and model shared by every scene."""
+    write_png(os.path.join(GENERATED, "block.png"), TILE_SIZE, TILE_SIZE)
+    write_png(os.path.join(GENERATED, "tiles.png"), TILE_SIZE * TILESET_COLUMNS, TILE_SIZE)
+
+    write(os.path.join(GENERATED, "mover.lua"),
+          "function update()\n"
+          "\tlocal x, y = get_Position(this)\n"
+          "\tif x > 2000 then x = 0 end\n"
+          "\tset_Position(this, x + 1, y)\n"
+          "end\n")
+
+    write(os.path.join(GENERATED, "tiles.tsx"),
+          '<?xml version="1.0" encoding="UTF-8"?>\n'
+          '<tileset version="1.10" name="tiles" tilewidth="%d" tileheight="%d" '
+          'tilecount="%d" columns="%d">\n'
+          ' <image source="tiles.png" width="%d" height="%d"/>\n'
+          '</tileset>\n'
+          % (TILE_SIZE, TILE_SIZE, TILESET_COLUMNS, TILESET_COLUMNS,
+             TILE_SIZE * TILESET_COLUMNS, TILE_SIZE))
+
+    # Cube with a single material
+    vertices = [(x, y, z) for x in (-1, 1) for y in (-1, 1) for z in (-1, 1)]
+    faces = [(1, 2, 4), (1, 4, 3), (5, 7, 8), (5, 8, 6), (1, 5, 6), (1, 6, 2),
+             (3, 4, 8), (3, 8, 7), (1, 3, 7), (1, 7, 5), (2, 6, 8), (2, 8, 4)]
+    lines = ["mtllib cube.mtl"]
+    lines += ["v %d %d %d" % v for v in vertices]
+    lines.append("usemtl white")
+    lines += ["f %d %d %d" % f for f in faces]
+    write(os.path.join(GENERATED, "cube.obj"), "\n".join(lines) + "\n")
+    write(os.path.join(GENERATED, "cube.mtl"),
+          "newmtl white\nNs 10\nKa 1 1 1\nKd 1 1 1\nKs 0 0 0\nd 1\nillum 2\n")
+
+
+def write_tilemap(size):
+    """Writes a size x size Tiled map with a ground layer and a border collision layer.
+
+    The CSV ends with a newline as Tiled writes it; the layer loader only
+    keeps numbers followed by a separator.
+    """
+    ground = ",".join(str(1 + (i % TILESET_COLUMNS)) for i in range(size * size))
+    collision = ",".join(
+        "1" if x in (0, size - 1) or y in (0, size - 1) else "0"
+        for y in range(size) for x in range(size))
+    path = os.path.join(GENERATED, "map_%d.tmx" % size)
+    write(path,
+          '<?xml version="1.0" encoding="UTF-8"?>\n'
+          '<map version="1.10" orientation="orthogonal" width="%d" height="%d" '
+          'tilewidth="%d" tileheight="%d">\n'
+          ' <tileset firstgid="1" source="tiles.tsx"/>\n'
+          ' <layer id="1" name="ground" width="%d" height="%d">\n'
+          '  <data encoding="csv">\n%s\n</data>\n'
+          ' </layer>\n'
+          ' <layer id="2" name="collision" width="%d" height="%d" visible="0">\n'
+          '  <data encoding="csv">\n%s\n</data>\n'
+          ' </layer>\n'
+          '</map>\n'
+          % (size, size, TILE_SIZE, TILE_SIZE, size, size, ground, size, size, collision))
+    return path
+
+
+def lua_list(items):
+    """Formats Lua table entries indexed from 0, as the scene loader reads them."""
+    return "".join("\t\t[%d] = %s,\n" % (i, item) for i, item in enumerate(items))
+
+
+def entity(components):
+    return "{ components = { %s } }" % ", ".join(components)
+
+
+def transform(x, y):
+    return "transform = { position = { x = %d, y = %d }, scale = { x = 1.0, y = 1.0 }, rotation = 0.0 }" % (x, y)
+
+
+def sprite(asset):
+    return ('sprite = { assetId = "%s", width = %d, height = %d, src_rect = { x = 0, y = 0 } }'
+            % (asset, TILE_SIZE, TILE_SIZE))
+
+
+def grid(count, spacing):
+    columns = max(1, int(count ** 0.5))
+    for i in range(count):
+        yield (i % columns) * spacing, (i // columns) * spacing
+
+
+def write_scene(name, count):
+    """Writes one scene file and returns its path."""
+    sprites = ['{ assetId = "block", filePath = "%s" }' % os.path.join(GENERATED, "block.png")]
+    objects = []
+    entities = []
+    maps = ""
+
+    if name == "sprites":
+        entities = [entity([transform(x, y), sprite("block")]) for x, y in grid(count, 8)]
+    elif name == "boxes":
+        # Neighbours overlap so the broadphase finds pairs every step
+        entities = [entity([
+            transform(x, y), sprite("block"),
+            "box_collider = { width = %d, height = %d, offset = { x = 0, y = 0 } }" % (TILE_SIZE, TILE_SIZE),
+            "rigidbody = { is_dynamic = true, is_solid = true, mass = 1 }",
+            'properties = { tag = "box" }']) for x, y in grid(count, TILE_SIZE - 4)]
+    elif name == "scripts":
+        entities = [entity([
+            transform(x, y), sprite("block"),
+            'script = { path = "%s" }' % os.path.join(GENERATED, "mover.lua")]) for x, y in grid(count, 8)]
+    elif name == "tilemap":
+        sprites.append('{ assetId = "tiles", filePath = "%s" }' % os.path.join(GENERATED, "tiles.png"))
+        maps = ('\t\tmap_path = "%s",\n\t\ttile_path = "%s",\n\t\ttile_name = "tiles",\n'
+                '\t\ttile_collision = true,\n'
+                % (write_tilemap(count), os.path.join(GENERATED, "tiles.tsx")))
+    elif name == "objects":
+        objects = ['{ assetId = "cube", filePath = "%s" }' % os.path.join(GENERATED, "cube.obj")]
+        entities = [entity([
+            transform(x, y),
+            'object = { assetId = "cube", xRot = 0.0, yRot = 0.0, sr = 20, sg = 20, sb = 20 }'])
+            for x, y in grid(count, 64)]
+
+    path = os.path.join(GENERATED, "%s_%d.lua" % (name, count))
+    write(path,
+          "scene = {\n"
+          "\tvideos = {},\n"
+          "\tobjects = {\n%s\t},\n"
+          "\tsfx = {},\n"
+          "\tmusic = {},\n"
+          "\tsprites = {\n%s\t},\n"
+          "\tanimations = {},\n"
+          "\tfonts = {},\n"
+          "\tkeys = {},\n"
+          "\tbuttons = {},\n"
+          "\tmaps = {\n%s\t},\n"
+          "\tentities = {\n%s\t}\n"
+          "}\n"
+          % (lua_list(objects), lua_list(sprites), maps, lua_list(entities)))
+    return path
+
+
+def run_scene(engine, scene_path, frames):
+    stats_path = scene_path[:-len(".lua")] + ".json"
+    if os.path.exists(stats_path):
+        os.remove(stats_path)
+    command = [engine, "--headless", "--frames", str(frames),
+               "--scene", scene_path, "--stats-json", stats_path]
+    result = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                            universal_newlines=True)
+    if result.returncode != 0 or not os.path.exists(stats_path):
+        sys.stderr.write("[SCENEBENCH] %s failed with status %d\n%s"
+                         % (scene_path, result.returncode, result.stderr))
+        return None
+    with open(stats_path) as file:
+        return json.load(file)
+
+
+def metrics(stats):
+    """Flattens the statistics of a scene to the values compared with the baseline."""
+    values = {
+        "load_ms": stats["load_ms"],
+        "frame_ms.avg": stats["frame_ms"]["avg"],
+        "frame_ms.p95": stats["frame_ms"]["p95"],
+    }
+    if stats.get("peak_memory_kb") is not None:
+        values["peak_memory_kb"] = stats["peak_memory_kb"]
+    for system in stats["systems"]:
+        values["systems.%s" % system["name"]] = system["mean_ms"]
+    return values
+
+
+def compare(results, baseline, threshold):
+    """Returns the metrics slower than the baseline by more than threshold."""
+    regressions = []
+    for key, stats in results.items():
+        if key not in baseline:
+            continue
+        current = metrics(stats)
+        previous = metrics(baseline[key])
+        for name, old in previous.items():
+            new = current.get(name)
+            if new is None:
+                continue
+            floor = FLOOR_MEMORY_KB if name == "peak_memory_kb" else FLOOR_MS
+            if new > old * (1.0 + threshold) and new - old > floor:
+                regressions.append("%s %s: %.4f -> %.4f (+%.1f%%)"
+                                   % (key, name, old, new, (new / old - 1.0) * 100.0 if old > 0 else 0.0))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Runs generated stress scenes headless and reports their statistics as JSON.")
+    parser.add_argument("--engine", default="./game_engine", help="engine executable")
+    parser.add_argument("--frames", type=int, default=600, help="frames simulated per scene")
+    parser.add_argument("--sprites", type=int, nargs="*", default=[1000, 10000], help="sprite counts")
+    parser.add_argument("--boxes", type=int, nargs="*", default=[500, 2000], help="box collider counts")
+    parser.add_argument("--scripts", type=int, nargs="*", default=[500, 2000], help="scripted entity counts")
+    parser.add_argument("--tilemaps", type=int, nargs="*", default=[128, 512], help="tile map side lengths")
+    parser.add_argument("--objects", type=int, nargs="*", default=[10, 100], help="3D object counts")
+    parser.add_argument("--output", help="file receiving the JSON report, stdout by default")
+    parser.add_argument("--baseline", help="report to compare against")
+    parser.add_argument("--threshold", type=float, default=0.15, help="allowed slowdown over the baseline, 0.15 is 15%%")
+    parser.add_argument("--write-baseline", help="also save the report as a baseline")
+    args = parser.parse_args()
+
+    if not os.path.exists("./assets/scripts/scenes.lua"):
+        sys.exit("[SCENEBENCH] Run from the engine folder")
+    os.makedirs(GENERATED, exist_ok=True)
+    write_assets()
+
+    cases = [("sprites", args.sprites), ("boxes", args.boxes), ("scripts", args.scripts),
+             ("tilemap", args.tilemaps), ("objects", args.objects)]
+    results = {}
+    failed = False
+    for name, counts in cases:
+        for count in counts:
+            key = "%s_%d" % (name, count)
+            sys.stderr.write("[SCENEBENCH] %s\n" % key)
+            stats = run_scene(args.engine, write_scene(name, count), args.frames)
+            if stats is None:
+                failed = True
+                continue
+            results[key] = stats
+
+    report = json.dumps({"benchmark": "scenes", "frames": args.frames, "scenes": results}, indent=2)
+    if args.output:
+        write(args.output, report + "\n")
+    else:
+        print(report)
+    if args.write_baseline:
+        write(args.write_baseline, report + "\n")
+
+    if args.baseline:
+        with open(args.baseline) as file:
+            baseline = json.load(file)["scenes"]
+        regressions = compare(results, baseline, args.threshold)
+        for regression in regressions:
+            sys.stderr.write("[SCENEBENCH] Regression %s\n" % regression)
+        if regressions:
+            return 1
+        sys.stderr.write("[SCENEBENCH] No regression over %.0f%%\n" % (args.threshold * 100.0))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,7 +1,13 @@
 #include "AssetManager.hpp"
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <SDL2/SDL_image.h>
 
+#include "SkylinePacker.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
+
 // Empty Constructor
 AssetManager::AssetManager() {
 	std::cout << "[ASSETMANAGER] Constructor is executed" << std::endl;
@@ -20,10 +26,15 @@ AssetManager::~AssetManager() {
 // Free Assets
 void AssetManager::ClearAssets() {
     // Free Textures
-    for (auto texture : textures) {
-        SDL_DestroyTexture(texture.second);
+    for (auto texture : texturePages) {
+        SDL_DestroyTexture(texture);
     }
+    texturePages.clear();
     textures.clear();
+    for (auto& image : pendingImages) {
+        SDL_FreeSurface(image.surface);
+    }
+    pendingImages.clear();
 
     // Free Fonts
     for (auto font : fonts) {
@@ -49,20 +60,149 @@ void AssetManager::ClearAssets() {
 // Add Texture to Scene
 void AssetManager::AddTexture(SDL_Renderer* renderer
 	, const std::string& textureId, const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::AddTexture");
 	SDL_Surface* surface = IMG_Load(filePath.c_str());
+	if (surface == NULL) {
+		std::cerr << "[ASSETMANAGER] Error loading texture: " << IMG_GetError() << std::endl;
+		return;
+	}
 	SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+	TextureRegion region;
+	region.texture = texture;
+	region.rect = { 0, 0, surface->w, surface->h };
 	SDL_FreeSurface(surface);
-	textures.emplace(textureId, texture);
+	RenderStats::CountUpload();
+	texturePages.push_back(texture);
+	textures.emplace(textureId, region);
+}
+
+// Queue Image for the Atlas
+void AssetManager::QueueAtlasImage(const std::string& textureId, const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::QueueAtlasImage");
+	SDL_Surface* surface = IMG_Load(filePath.c_str());
+	if (surface == NULL) {
+		std::cerr << "[ASSETMANAGER] Error loading texture: " << IMG_GetError() << std::endl;
+		return;
+	}
+	pendingImages.push_back({ textureId, surface });
+}
+
+// Pack Queued Images into Atlas Pages
+void AssetManager::BuildTextureAtlas(SDL_Renderer* renderer) {
+	PROFILE_SCOPE("AssetManager::BuildTextureAtlas");
+	if (pendingImages.empty()) {
+		return;
+	}
+
+	int pageSize = ATLAS_PAGE_SIZE;
+	SDL_RendererInfo info;
+	if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0
+		&& info.max_texture_height > 0) {
+		pageSize = std::min({ pageSize, info.max_texture_width, info.max_texture_height });
+	}
+
+	// Tallest images first keep the skyline flat; ties keep the load order
+	std::vector<size_t> order(pendingImages.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+		const SDL_Surface* first = pendingImages[a].surface;
+		const SDL_Surface* second = pendingImages[b].surface;
+		return first->h != second->h ? first->h > second->h : first->w > second->w;
+	});
+
+	std::vector<SkylinePacker> pages;
+	std::vector<std::vector<std::pair<size_t, SDL_Rect>>> placements;
+	for (size_t index : order) {
+		SDL_Surface* surface = pendingImages[index].surface;
+		int paddedWidth = surface->w + ATLAS_PADDING * 2;
+		int paddedHeight = surface->h + ATLAS_PADDING * 2;
+
+		// Too large to share a page, keeps a texture of its own
+		if (paddedWidth > pageSize || paddedHeight > pageSize) {
+			SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+			RenderStats::CountUpload();
+			texturePages.push_back(texture);
+			TextureRegion region;
+			region.texture = texture;
+			region.rect = { 0, 0, surface->w, surface->h };
+			textures.emplace(pendingImages[index].textureId, region);
+			continue;
+		}
+
+		SDL_Rect rect;
+		size_t page = 0;
+		while (page < pages.size() && !pages[page].Insert(paddedWidth, paddedHeight, rect)) {
+			page++;
+		}
+		if (page == pages.size()) {
+			pages.emplace_back(pageSize, pageSize);
+			placements.emplace_back();
+			pages[page].Insert(paddedWidth, paddedHeight, rect);
+		}
+		rect = { rect.x + ATLAS_PADDING, rect.y + ATLAS_PADDING, surface->w, surface->h };
+		placements[page].push_back({ index, rect });
+	}
+
+	for (const auto& placement : placements) {
+		// Trim the page to the images it holds
+		int width = 0;
+		int height = 0;
+		for (const auto& image : placement) {
+			width = std::max(width, image.second.x + image.second.w + ATLAS_PADDING);
+			height = std::max(height, image.second.y + image.second.h + ATLAS_PADDING);
+		}
+
+		SDL_Surface* pageSurface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32
+			, SDL_PIXELFORMAT_RGBA32);
+		if (pageSurface == NULL) {
+			std::cerr << "[ASSETMANAGER] Error creating atlas page: " << SDL_GetError() << std::endl;
+			continue;
+		}
+		for (const auto& image : placement) {
+			// Copy the pixels as they are, alpha included
+			SDL_Surface* surface = pendingImages[image.first].surface;
+			SDL_Rect destination = image.second;
+			SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surface, NULL, pageSurface, &destination);
+		}
+
+		SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, pageSurface);
+		SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+		SDL_FreeSurface(pageSurface);
+		RenderStats::CountUpload();
+		texturePages.push_back(texture);
+		for (const auto& image : placement) {
+			TextureRegion region;
+			region.texture = texture;
+			region.rect = image.second;
+			textures.emplace(pendingImages[image.first].textureId, region);
+		}
+	}
+
+	std::cout << "[ASSETMANAGER] Packed " << pendingImages.size() << " images into "
+		<< placements.size() << " atlas pages" << std::endl;
+	for (auto& image : pendingImages) {
+		SDL_FreeSurface(image.surface);
+	}
+	pendingImages.clear();
 }
 
 // Get Texture from Scene
 SDL_Texture* AssetManager::GetTexture(const std::string& textureId) {
-	return textures[textureId];
+	return GetTextureRegion(textureId).texture;
+}
+
+// Get Texture Region from Scene
+const AssetManager::TextureRegion& AssetManager::GetTextureRegion(const std::string& textureId) const {
+	static const TextureRegion missing;
+	auto it = textures.find(textureId);
+	return it != textures.end() ? it->second : missing;
 }
 
 // Add Font to Scene
 void AssetManager::AddFont(const std::string & fontId, const std::string& filePath
 	, int fontSize) {
+	PROFILE_SCOPE("AssetManager::AddFont");
 	TTF_Font* font = TTF_OpenFont(filePath.c_str(), fontSize);
 	if (font == NULL) {
 		std::string error = TTF_GetError();
@@ -79,6 +219,7 @@ TTF_Font* AssetManager::GetFont(const std::string& fontId) {
 
 // Add Sound to Scene
 void AssetManager::AddSoundEffect(const std::string& soundId, const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::AddSoundEffect");
 	Mix_Chunk* sound = Mix_LoadWAV(filePath.c_str());
 	if (sound == NULL) {
 		std::cerr << "[ASSETMANAGER] Error loading sound effect: " << Mix_GetError() << std::endl;
@@ -94,6 +235,7 @@ Mix_Chunk* AssetManager::GetSoundEffect(const std::string& soundId) {
 
 // Add Music to Scene
 void AssetManager::AddMusic(const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::AddMusic");
     if (filePath != musicName) {
         // Free Music
         if (musicTrack != nullptr) {
@@ -124,6 +266,7 @@ std::string AssetManager::GetMusicName() {
 // Add Video to Scene
 void AssetManager::AddVideo(SDL_Renderer* renderer, const std::string& videoId
     , const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::AddVideo");
     std::cout << "[ASSETMANAGER] Adding video with Id: " << videoId << std::endl;
 
     // Open the File
@@ -192,6 +335,7 @@ AssetManager::VideoAsset AssetManager::GetVideo(const std::string& videoId) {
 
 // Function to load a 3D object from an OBJ file
 void AssetManager::Add3dObject(const std::string& objectId, const std::string& filePath) {
+	PROFILE_SCOPE("AssetManager::Add3dObject");
     // Load OBJ file
     std::ifstream file(filePath);
     if (!file.is_open()) {
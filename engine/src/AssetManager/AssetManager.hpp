@@ -51,6 +51,11 @@ extern "C" {
  * All assets are stored in memory and can be accessed using their unique identifiers.
  * The manager handles proper cleanup of resources when destroyed.
  *
+ * Scene sprites are queued with QueueAtlasImage and packed by
+ * BuildTextureAtlas into a few atlas pages, so consecutive sprites of
+ * different images can still be drawn with one call. Every image keeps its
+ * own id and pixel coordinates; GetTextureRegion tells where it lives.
+ *
  * @note This class requires SDL2, SDL2_ttf, SDL2_mixer, and FFmpeg libraries
  */
 
@@ -87,8 +92,29 @@ public:
 		std::unordered_map<std::string, Material> Mtl; // Store materials by name
 	};
 
+	/**
+	 * @brief Texture holding an image and the area the image covers in it
+	 */
+	struct TextureRegion {
+		SDL_Texture* texture = nullptr; ///< Atlas page or own texture of the image, null if not loaded.
+		SDL_Rect rect = { 0, 0, 0, 0 }; ///< Area of the image in the texture.
+	};
+
 private:
-	std::map<std::string, SDL_Texture*> textures;
+	/**
+	 * @brief Image loaded by QueueAtlasImage, waiting for BuildTextureAtlas
+	 */
+	struct PendingImage {
+		std::string textureId; ///< Id the image is registered under.
+		SDL_Surface* surface; ///< Pixels of the image.
+	};
+
+	static constexpr int ATLAS_PAGE_SIZE = 2048; ///< Largest atlas page side, lowered to the renderer limit.
+	static constexpr int ATLAS_PADDING = 1; ///< Transparent pixels kept around every packed image.
+
+	std::map<std::string, TextureRegion> textures;
+	std::vector<SDL_Texture*> texturePages; ///< Every texture created for images, atlas pages included.
+	std::vector<PendingImage> pendingImages; ///< Images queued for the next atlas.
 	std::map<std::string, TTF_Font*> fonts;
 	std::map<std::string, Mix_Chunk*> soundEffects;
 	Mix_Chunk* musicTrack = nullptr;
@@ -136,16 +162,50 @@ public:
 	 */
 	void AddTexture(SDL_Renderer* renderer, const std::string& textureId
 		, const std::string& filePath);
+
+	/**
+	 * @brief Loads an image to be packed by the next BuildTextureAtlas
+	 * @param textureId Unique identifier for the image
+	 * @param filePath Path to the image file
+	 *
+	 * @details The image has no texture until BuildTextureAtlas runs.
+	 *
+	 * @see BuildTextureAtlas()
+	 */
+	void QueueAtlasImage(const std::string& textureId, const std::string& filePath);
+
+	/**
+	 * @brief Packs the queued images into atlas pages
+	 * @param renderer The SDL renderer used to create the pages
+	 *
+	 * @details Images are placed tallest first with a SkylinePacker, each page
+	 * trimmed to the area used. Images larger than a page get their own texture.
+	 * Every image is surrounded by ATLAS_PADDING transparent pixels so linear
+	 * filtering does not pick up its neighbours.
+	 */
+	void BuildTextureAtlas(SDL_Renderer* renderer);
 	
 	/**
 	 * @brief Retrieves a texture by its ID
 	 * @param textureId The unique identifier for the texture
-	 * @return SDL_Texture* Pointer to the requested texture
+	 * @return SDL_Texture* Pointer to the texture holding the image, which may
+	 * be an atlas page shared with other images
 	 *
 	 * @see AddTexture()
+	 * @see GetTextureRegion()
 	 */
 	SDL_Texture* GetTexture(const std::string& textureId);
 
+	/**
+	 * @brief Retrieves the texture and area of an image by its ID
+	 * @param textureId The unique identifier for the image
+	 * @return The region, with a null texture if the ID is not loaded
+	 *
+	 * @details Source rectangles relative to the image become texture
+	 * coordinates by adding the position of the region.
+	 */
+	const TextureRegion& GetTextureRegion(const std::string& textureId) const;
+
 	/**
 	 * @brief Loads and adds a font to the asset manager
 	 * @param fontId Unique identifier for the font
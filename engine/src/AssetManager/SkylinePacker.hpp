@@ -0,0 +1,142 @@
+/**
+ * @file SkylinePacker.hpp
+ * @brief Rectangle packer used to place images in texture atlas pages
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup AssetManagement
+ */
+
+#ifndef SKYLINEPACKER_HPP
+#define SKYLINEPACKER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+/**
+ * @brief Packs rectangles into a fixed size page with the skyline bottom-left rule.
+ *
+ * The page is described by its skyline: the top edge of the rectangles
+ * placed so far, as a list of horizontal segments from left to right. A
+ * new rectangle goes where its bottom edge ends lowest, ties going to the
+ * narrowest segment, so the space under the skyline that can no longer be
+ * reached stays small. Inserting is linear in the number of segments.
+ */
+class SkylinePacker {
+private:
+    /**
+     * @brief Horizontal piece of the skyline.
+     */
+    struct Segment {
+        int x; /**< Left edge */
+        int y; /**< Height of the skyline over the segment */
+        int width; /**< Width of the segment */
+    };
+
+    int width; /**< Page width */
+    int height; /**< Page height */
+    std::vector<Segment> skyline; /**< Segments from left to right, covering the page width */
+
+    /**
+     * @brief Gets the lowest y at which a rectangle fits with its left edge on a segment.
+     * @return The y coordinate, or -1 if the rectangle does not fit there.
+     */
+    int Fit(size_t index, int rectWidth, int rectHeight) const {
+        int x = skyline[index].x;
+        if (x + rectWidth > width) {
+            return -1;
+        }
+
+        // The rectangle rests on the highest segment it spans
+        int y = 0;
+        int remaining = rectWidth;
+        for (size_t i = index; remaining > 0; i++) {
+            if (skyline[i].y > y) {
+                y = skyline[i].y;
+            }
+            remaining -= skyline[i].width;
+        }
+        return y + rectHeight <= height ? y : -1;
+    }
+
+    /**
+     * @brief Raises the skyline over a placed rectangle.
+     */
+    void AddSegment(size_t index, const SDL_Rect& rect) {
+        skyline.insert(skyline.begin() + index, { rect.x, rect.y + rect.h, rect.w });
+
+        // Cut the segments now hidden under the new one
+        size_t next = index + 1;
+        while (next < skyline.size()) {
+            int coveredEnd = skyline[next - 1].x + skyline[next - 1].width;
+            if (skyline[next].x >= coveredEnd) {
+                break;
+            }
+            int shrink = coveredEnd - skyline[next].x;
+            skyline[next].x += shrink;
+            skyline[next].width -= shrink;
+            if (skyline[next].width > 0) {
+                break;
+            }
+            skyline.erase(skyline.begin() + next);
+        }
+
+        // Join neighbours of the same height so the list stays short
+        for (size_t i = 0; i + 1 < skyline.size();) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs an empty page.
+     * @param width Page width in pixels.
+     * @param height Page height in pixels.
+     */
+    SkylinePacker(int width, int height) : width(width), height(height) {
+        skyline.push_back({ 0, 0, width });
+    }
+
+    /**
+     * @brief Places a rectangle in the page.
+     * @param rectWidth Width of the rectangle.
+     * @param rectHeight Height of the rectangle.
+     * @param rect Output position and size of the rectangle.
+     * @return False if the page has no room left for it.
+     */
+    bool Insert(int rectWidth, int rectHeight, SDL_Rect& rect) {
+        if (rectWidth <= 0 || rectHeight <= 0) {
+            return false;
+        }
+
+        size_t bestIndex = skyline.size();
+        int bestBottom = height + 1;
+        int bestWidth = width + 1;
+        for (size_t i = 0; i < skyline.size(); i++) {
+            int y = Fit(i, rectWidth, rectHeight);
+            if (y < 0) {
+                continue;
+            }
+            int bottom = y + rectHeight;
+            if (bottom < bestBottom || (bottom == bestBottom && skyline[i].width < bestWidth)) {
+                bestIndex = i;
+                bestBottom = bottom;
+                bestWidth = skyline[i].width;
+                rect = { skyline[i].x, y, rectWidth, rectHeight };
+            }
+        }
+        if (bestIndex == skyline.size()) {
+            return false;
+        }
+
+        AddSegment(bestIndex, rect);
+        return true;
+    }
+};
+
+#endif // SKYLINEPACKER_HPP
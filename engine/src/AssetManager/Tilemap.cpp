@@ -0,0 +1,261 @@
+#include "Tilemap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
+
+namespace {
+	// Tiled stores the flip state in the top bits of every gid
+	const uint32_t FLIP_HORIZONTAL = 0x80000000;
+	const uint32_t FLIP_VERTICAL = 0x40000000;
+	const uint32_t FLIP_DIAGONAL = 0x20000000;
+	const uint32_t TILE_ID_MASK = ~(FLIP_HORIZONTAL | FLIP_VERTICAL | FLIP_DIAGONAL);
+}
+
+Tilemap::Tilemap() {
+	// Baked pixels are premultiplied by their alpha, blending them again
+	// with SDL_BLENDMODE_BLEND would darken the soft edges of the tiles
+	chunkBlendMode = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+}
+
+Tilemap::~Tilemap() {
+	Clear();
+}
+
+void Tilemap::Reset(int tileWidth, int tileHeight, int columns, int rows
+	, const std::string& tileSet, int tileSetColumns) {
+	Clear();
+	this->tileWidth = std::max(tileWidth, 1);
+	this->tileHeight = std::max(tileHeight, 1);
+	this->columns = std::max(columns, 0);
+	this->rows = std::max(rows, 0);
+	this->tileSet = tileSet;
+	this->tileSetColumns = std::max(tileSetColumns, 1);
+
+	chunkColumns = (this->columns * this->tileWidth + CHUNK_SIZE - 1) / CHUNK_SIZE;
+	chunkRows = (this->rows * this->tileHeight + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+int Tilemap::AddLayer(const std::string& name, std::vector<uint32_t> tiles) {
+	tiles.resize(static_cast<size_t>(columns) * rows, 0);
+	layers.push_back({ name, std::move(tiles) });
+	chunks.resize(chunks.size() + static_cast<size_t>(chunkColumns) * chunkRows);
+	return static_cast<int>(layers.size()) - 1;
+}
+
+Tilemap::Layer* Tilemap::FindLayer(const std::string& name) {
+	for (auto& layer : layers) {
+		if (layer.name == name) {
+			return &layer;
+		}
+	}
+	return nullptr;
+}
+
+bool Tilemap::SetTile(const std::string& layerName, int x, int y, uint32_t tile) {
+	Layer* layer = FindLayer(layerName);
+	if (layer == nullptr || x < 0 || y < 0 || x >= columns || y >= rows) {
+		return false;
+	}
+	uint32_t& cell = layer->tiles[static_cast<size_t>(y) * columns + x];
+	if (cell == tile) {
+		return true;
+	}
+	cell = tile;
+
+	// A tile may straddle a chunk border, every chunk under it is baked again
+	int layerIndex = static_cast<int>(layer - layers.data());
+	int minChunkX = x * tileWidth / CHUNK_SIZE;
+	int minChunkY = y * tileHeight / CHUNK_SIZE;
+	int maxChunkX = std::min(((x + 1) * tileWidth - 1) / CHUNK_SIZE, chunkColumns - 1);
+	int maxChunkY = std::min(((y + 1) * tileHeight - 1) / CHUNK_SIZE, chunkRows - 1);
+	for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+		for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+			chunks[ChunkIndex(layerIndex, chunkX, chunkY)].isDirty = true;
+		}
+	}
+	return true;
+}
+
+uint32_t Tilemap::GetTile(const std::string& layerName, int x, int y) {
+	Layer* layer = FindLayer(layerName);
+	if (layer == nullptr || x < 0 || y < 0 || x >= columns || y >= rows) {
+		return 0;
+	}
+	return layer->tiles[static_cast<size_t>(y) * columns + x];
+}
+
+SDL_Texture* Tilemap::AcquireTexture(SDL_Renderer* renderer) {
+	// Over budget, take the texture of the chunk unseen for the longest time
+	if (bakedCount >= MAX_BAKED_CHUNKS) {
+		Chunk* oldest = nullptr;
+		for (auto& chunk : chunks) {
+			if (chunk.texture != nullptr && chunk.lastSeen != frame
+				&& (oldest == nullptr || chunk.lastSeen < oldest->lastSeen)) {
+				oldest = &chunk;
+			}
+		}
+		if (oldest != nullptr) {
+			SDL_Texture* texture = oldest->texture;
+			oldest->texture = nullptr;
+			oldest->isDirty = true;
+			return texture;
+		}
+	}
+
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888
+		, SDL_TEXTUREACCESS_TARGET, CHUNK_SIZE, CHUNK_SIZE);
+	if (texture == nullptr) {
+		std::cerr << "[TILEMAP] Error creating chunk texture: " << SDL_GetError() << std::endl;
+		return nullptr;
+	}
+	if (SDL_SetTextureBlendMode(texture, chunkBlendMode) != 0) {
+		chunkBlendMode = SDL_BLENDMODE_BLEND;
+		SDL_SetTextureBlendMode(texture, chunkBlendMode);
+	}
+	bakedCount++;
+	return texture;
+}
+
+void Tilemap::BakeChunk(SDL_Renderer* renderer, int layer, int chunkX, int chunkY
+	, const AssetManager::TextureRegion& region) {
+	PROFILE_SCOPE("Tilemap::BakeChunk");
+	Chunk& chunk = chunks[ChunkIndex(layer, chunkX, chunkY)];
+	if (chunk.texture == nullptr) {
+		chunk.texture = AcquireTexture(renderer);
+		if (chunk.texture == nullptr) {
+			return;
+		}
+	}
+
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+	Uint8 r, g, b, a;
+	SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+	SDL_SetRenderTarget(renderer, chunk.texture);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+
+	int originX = chunkX * CHUNK_SIZE;
+	int originY = chunkY * CHUNK_SIZE;
+	int minColumn = originX / tileWidth;
+	int minRow = originY / tileHeight;
+	int maxColumn = std::min((originX + CHUNK_SIZE - 1) / tileWidth, columns - 1);
+	int maxRow = std::min((originY + CHUNK_SIZE - 1) / tileHeight, rows - 1);
+
+	batch.Reset();
+	const std::vector<uint32_t>& tiles = layers[layer].tiles;
+	for (int y = minRow; y <= maxRow; y++) {
+		for (int x = minColumn; x <= maxColumn; x++) {
+			uint32_t tile = tiles[static_cast<size_t>(y) * columns + x];
+			uint32_t tileId = tile & TILE_ID_MASK;
+			if (tileId == 0) {
+				continue;
+			}
+
+			SDL_Rect srcRect = {
+				region.rect.x + static_cast<int>((tileId - 1) % tileSetColumns) * tileWidth,
+				region.rect.y + static_cast<int>((tileId - 1) / tileSetColumns) * tileHeight,
+				tileWidth,
+				tileHeight
+			};
+			if (!SDL_IntersectRect(&srcRect, &region.rect, &srcRect)) {
+				continue;
+			}
+			SDL_Rect dstRect = { x * tileWidth - originX, y * tileHeight - originY, tileWidth, tileHeight };
+			batch.Draw(renderer, region.texture, srcRect, dstRect, 0.0, (tile & FLIP_HORIZONTAL) != 0);
+		}
+	}
+	batch.Flush(renderer);
+
+	SDL_SetRenderTarget(renderer, previousTarget);
+	SDL_SetRenderDrawColor(renderer, r, g, b, a);
+	RenderStats::CountUpload();
+	chunk.isDirty = false;
+}
+
+void Tilemap::BeginFrame() {
+	frame++;
+}
+
+void Tilemap::RenderLayer(SDL_Renderer* renderer, const SDL_Rect& camera
+	, const std::unique_ptr<AssetManager>& assetManager, int layer) {
+	PROFILE_SCOPE("Tilemap::RenderLayer");
+	if (layer < 0 || layer >= static_cast<int>(layers.size()) || chunkColumns == 0 || chunkRows == 0) {
+		return;
+	}
+	const AssetManager::TextureRegion& region = assetManager->GetTextureRegion(tileSet);
+	if (region.texture == nullptr) {
+		return;
+	}
+
+	int minChunkX = std::max(0, static_cast<int>(std::floor(camera.x / static_cast<double>(CHUNK_SIZE))));
+	int minChunkY = std::max(0, static_cast<int>(std::floor(camera.y / static_cast<double>(CHUNK_SIZE))));
+	int maxChunkX = std::min(chunkColumns - 1
+		, static_cast<int>(std::floor((camera.x + camera.w - 1) / static_cast<double>(CHUNK_SIZE))));
+	int maxChunkY = std::min(chunkRows - 1
+		, static_cast<int>(std::floor((camera.y + camera.h - 1) / static_cast<double>(CHUNK_SIZE))));
+
+	// Chunks in view are marked first so baking never takes their textures
+	for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+		for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+			chunks[ChunkIndex(layer, chunkX, chunkY)].lastSeen = frame;
+		}
+	}
+
+	int mapWidth = columns * tileWidth;
+	int mapHeight = rows * tileHeight;
+	for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++) {
+		for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++) {
+			Chunk& chunk = chunks[ChunkIndex(layer, chunkX, chunkY)];
+			if (chunk.isDirty || chunk.texture == nullptr) {
+				BakeChunk(renderer, layer, chunkX, chunkY, region);
+				if (chunk.texture == nullptr) {
+					continue;
+				}
+			}
+
+			// Chunks on the right and bottom edges are only partly used
+			int originX = chunkX * CHUNK_SIZE;
+			int originY = chunkY * CHUNK_SIZE;
+			SDL_Rect srcRect = { 0, 0, std::min(CHUNK_SIZE, mapWidth - originX)
+				, std::min(CHUNK_SIZE, mapHeight - originY) };
+			SDL_Rect dstRect = { originX - camera.x, originY - camera.y, srcRect.w, srcRect.h };
+			RenderStats::CountDraw();
+			SDL_RenderCopy(renderer, chunk.texture, &srcRect, &dstRect);
+		}
+	}
+}
+
+void Tilemap::InvalidateChunks() {
+	for (auto& chunk : chunks) {
+		chunk.isDirty = true;
+	}
+}
+
+void Tilemap::Clear() {
+	for (auto& chunk : chunks) {
+		if (chunk.texture != nullptr) {
+			SDL_DestroyTexture(chunk.texture);
+		}
+	}
+	chunks.clear();
+	layers.clear();
+	chunkColumns = 0;
+	chunkRows = 0;
+	bakedCount = 0;
+	columns = 0;
+	rows = 0;
+}
+
+int Tilemap::GetLayerCount() const {
+	return static_cast<int>(layers.size());
+}
+
+int Tilemap::GetBakedCount() const {
+	return bakedCount;
+}
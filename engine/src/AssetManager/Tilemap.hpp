@@ -0,0 +1,188 @@
+/**
+ * @file Tilemap.hpp
+ * @brief Static tile layers baked into chunk textures instead of entities
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup AssetManagement
+ */
+
+#ifndef TILEMAP_HPP
+#define TILEMAP_HPP
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AssetManager.hpp"
+#include "../Utils/SpriteBatch.hpp"
+
+/**
+ * @class Tilemap
+ * @brief Keeps the tile layers of a Tiled map and draws them as chunks.
+ *
+ * The SceneLoader stores every tile layer here as an array of Tiled gids,
+ * flip bits included, instead of creating one entity per tile. Every layer
+ * is split in CHUNK_SIZE square chunks; a chunk is baked on first sight by
+ * drawing the layer's tiles into a render target texture, and is then
+ * drawn as a single quad while it stays in view. Layers are baked apart so
+ * the RenderSystem can draw each of them where its tiles used to be in the
+ * draw order, between the sprites created before and after it.
+ *
+ * Chunk textures are pooled: once more than MAX_BAKED_CHUNKS are baked,
+ * the chunk unseen for the longest time hands its texture over, so memory
+ * follows the screen size rather than the map size. SetTile only marks the
+ * chunk of the tile as dirty, it is baked again before its next draw.
+ *
+ * Baking needs a renderer that supports render targets; the SceneLoader
+ * falls back to tile entities when it does not.
+ */
+class Tilemap {
+private:
+    /** @brief Side of a chunk in pixels */
+    static constexpr int CHUNK_SIZE = 512;
+
+    /** @brief Baked chunks kept before textures are taken from unseen chunks */
+    static constexpr int MAX_BAKED_CHUNKS = 64;
+
+    /**
+     * @brief One tile layer of the map.
+     */
+    struct Layer {
+        std::string name; /**< Layer name in the Tiled file */
+        std::vector<uint32_t> tiles; /**< Tiled gid of every cell, row after row, 0 when empty */
+    };
+
+    /**
+     * @brief Square area of the map baked into one texture.
+     */
+    struct Chunk {
+        SDL_Texture* texture = nullptr; /**< Baked tiles, null until first seen */
+        bool isDirty = true; /**< True when the texture does not match the tiles */
+        unsigned int lastSeen = 0; /**< Frame in which the chunk was last drawn */
+    };
+
+    int tileWidth = 0; /**< Tile width in pixels */
+    int tileHeight = 0; /**< Tile height in pixels */
+    int columns = 0; /**< Tiles per row */
+    int rows = 0; /**< Tiles per column */
+    std::string tileSet; /**< Texture id of the tileset */
+    int tileSetColumns = 1; /**< Tiles per row in the tileset */
+
+    std::vector<Layer> layers; /**< Layers in draw order */
+    std::vector<Chunk> chunks; /**< Chunks of every layer, layer after layer and row after row */
+    int chunkColumns = 0; /**< Chunks per row */
+    int chunkRows = 0; /**< Chunks per column */
+    int bakedCount = 0; /**< Chunks holding a texture */
+    unsigned int frame = 0; /**< Frames started with BeginFrame, used to find unseen chunks */
+    SDL_BlendMode chunkBlendMode = SDL_BLENDMODE_BLEND; /**< Blend mode of the chunk textures */
+    SpriteBatch batch; /**< Tiles of the chunk being baked */
+
+    /**
+     * @brief Finds a layer by name.
+     * @return The layer, or nullptr if the map has none with that name.
+     */
+    Layer* FindLayer(const std::string& name);
+
+    /**
+     * @brief Gets the position of a chunk of a layer in the chunks array.
+     */
+    size_t ChunkIndex(int layer, int chunkX, int chunkY) const {
+        return (static_cast<size_t>(layer) * chunkRows + chunkY) * chunkColumns + chunkX;
+    }
+
+    /**
+     * @brief Gets a texture for a chunk, creating it or taking it from an unseen chunk.
+     */
+    SDL_Texture* AcquireTexture(SDL_Renderer* renderer);
+
+    /**
+     * @brief Draws the tiles of a layer covering a chunk into its texture.
+     */
+    void BakeChunk(SDL_Renderer* renderer, int layer, int chunkX, int chunkY,
+        const AssetManager::TextureRegion& region);
+
+public:
+    /**
+     * @brief Constructs an empty Tilemap.
+     */
+    Tilemap();
+
+    /**
+     * @brief Destroys the Tilemap and its chunk textures.
+     */
+    ~Tilemap();
+
+    /**
+     * @brief Forgets the layers and sets the grid of a new map.
+     * @param tileWidth Tile width in pixels.
+     * @param tileHeight Tile height in pixels.
+     * @param columns Map width in tiles.
+     * @param rows Map height in tiles.
+     * @param tileSet Texture id of the tileset.
+     * @param tileSetColumns Tiles per row in the tileset.
+     */
+    void Reset(int tileWidth, int tileHeight, int columns, int rows,
+        const std::string& tileSet, int tileSetColumns);
+
+    /**
+     * @brief Adds a layer.
+     * @param name Layer name used by SetTile and GetTile.
+     * @param tiles Tiled gids row after row; missing cells are empty.
+     * @return The index of the layer, used by RenderLayer.
+     */
+    int AddLayer(const std::string& name, std::vector<uint32_t> tiles);
+
+    /**
+     * @brief Changes one tile and marks its chunk for baking.
+     * @param layerName Name of the layer.
+     * @param x Column of the tile.
+     * @param y Row of the tile.
+     * @param tile Tiled gid with its flip bits, 0 to empty the cell.
+     * @return False if the layer or the cell does not exist.
+     */
+    bool SetTile(const std::string& layerName, int x, int y, uint32_t tile);
+
+    /**
+     * @brief Gets one tile.
+     * @return The Tiled gid of the cell, 0 if empty or out of the map.
+     */
+    uint32_t GetTile(const std::string& layerName, int x, int y);
+
+    /**
+     * @brief Starts a frame; chunks drawn since are never handed to other chunks.
+     */
+    void BeginFrame();
+
+    /**
+     * @brief Bakes the dirty chunks of a layer in view and draws them.
+     * @param renderer Renderer drawing the frame.
+     * @param camera Camera viewport in world coordinates.
+     * @param assetManager Asset manager holding the tileset.
+     * @param layer Index returned by AddLayer.
+     */
+    void RenderLayer(SDL_Renderer* renderer, const SDL_Rect& camera,
+        const std::unique_ptr<AssetManager>& assetManager, int layer);
+
+    /**
+     * @brief Marks every chunk for baking, e.g. after the renderer lost its render targets.
+     */
+    void InvalidateChunks();
+
+    /**
+     * @brief Forgets the map and destroys the chunk textures.
+     */
+    void Clear();
+
+    /**
+     * @brief Gets the number of layers of the map.
+     */
+    int GetLayerCount() const;
+
+    /**
+     * @brief Gets the number of chunks holding a texture.
+     */
+    int GetBakedCount() const;
+};
+
+#endif // TILEMAP_HPP
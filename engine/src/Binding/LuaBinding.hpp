@@ -17,7 +17,12 @@
 #define LUABINDING_HPP
 
 #include <SDL2/SDL.h>
+#include <sol/sol.hpp>
+#include <iostream>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include "../AnimationManager/AnimationManager.hpp"
 #include "../Components/AnimationComponent.hpp"
 #include "../Components/BoxColliderComponent.hpp"
@@ -28,6 +33,9 @@
 #include "../Components/TransformComponent.hpp"
 #include "../Components/TextComponent.hpp"
 #include "../Game/Game.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Systems/BoxCollisionSystem.hpp"
+#include "../Systems/RenderSystem.hpp"
 
  /**
   * @brief Changes the animation of a given entity.
@@ -52,6 +60,7 @@ void ChangeAnimation(Entity entity, const std::string & animationId) {
     sprite.height = animationData.height;
     sprite.srcRect.x = 0;
     sprite.srcRect.y = 0;
+    Game::GetInstance().registry->GetSystem<RenderSystem>().MarkMoved(entity);
 
     animation.currentFrame = 1;
     animation.frameSpeedRate = animationData.frameSpeedRate;
@@ -127,6 +136,7 @@ void SetVelocity(Entity entity, float x, float y) {
         auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
         rigidbody.velocity.x = x;
         rigidbody.velocity.y = y;
+        rigidbody.WakeUp();
     }
 }
 
@@ -141,6 +151,7 @@ void SetVelocity(Entity entity, float x, float y) {
 void AddForce(Entity entity, float x, float y) {
     auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
     rigidbody.sumForces += glm::vec2(x, y);
+    rigidbody.WakeUp();
 
 }
 
@@ -166,6 +177,10 @@ std::pair<float, float> GetPosition(Entity entity) {
  * @param x New X coordinate
  * @param y New Y coordinate
  *
+ * The entity is teleported: previousPosition is moved too, so the render
+ * does not interpolate across the jump and the collision systems do not
+ * sweep it.
+ *
  * @note Can be called from Lua as: set_Position(entity, x, y)
  */
 void SetPosition(Entity entity, float x, float y) {
@@ -173,6 +188,11 @@ void SetPosition(Entity entity, float x, float y) {
         auto& transform = entity.GetComponent<TransformComponent>();
         transform.position.x = x;
         transform.position.y = y;
+        transform.previousPosition = transform.position;
+        Game::GetInstance().registry->GetSystem<RenderSystem>().MarkMoved(entity);
+    }
+    if (entity.HasComponent<RigidBodyComponent>()) {
+        entity.GetComponent<RigidBodyComponent>().WakeUp();
     }
 }
 
@@ -202,6 +222,7 @@ void SetRotation(Entity entity, double rot) {
     if (entity.HasComponent<TransformComponent>()) {
         auto& transform = entity.GetComponent<TransformComponent>();
         transform.rotation = rot;
+        Game::GetInstance().registry->GetSystem<RenderSystem>().MarkMoved(entity);
     }
 }
 
@@ -311,6 +332,7 @@ void SetRigid(Entity entity, bool dynamic, bool solid) {
         auto& property = entity.GetComponent<RigidBodyComponent>();
         property.isDynamic = dynamic;
         property.isSolid = solid;
+        property.WakeUp();
     }
 }
 
@@ -521,6 +543,7 @@ std::string GetDirCollision(Entity a, Entity b) {
 void SetSolid(Entity entity, bool isSolid) {
     auto& platform = entity.GetComponent<RigidBodyComponent>();
     platform.isSolid=isSolid;
+    platform.WakeUp();
 }
 
 bool GetSolid(Entity entity){
@@ -554,6 +577,53 @@ Uint32 GetTime() {
     return SDL_GetTicks();
 }
 
+/**
+ * @brief Sets the frame rate limit
+ * @param fps Frames per second, 0 or less runs uncapped
+ *
+ * @note Can be called from Lua as: set_target_fps(144)
+ */
+void SetTargetFps(double fps) {
+    Game::GetInstance().framePacer->SetTargetRate(fps);
+}
+
+/**
+ * @brief Turns vertical sync on or off
+ * @param enabled True to pace frames on the display refresh
+ *
+ * @note Can be called from Lua as: set_vsync(true)
+ */
+void SetVsync(bool enabled) {
+    Game::GetInstance().SetVsync(enabled);
+}
+
+/**
+ * @brief Gets the frame time statistics of the most recent frames
+ * @return Average, standard deviation, minimum and maximum frame time in milliseconds
+ *
+ * @note Can be called from Lua as: avg, stddev, min, max = get_frame_stats()
+ */
+std::tuple<double, double, double, double> GetFrameStats() {
+    FrameStats stats = Game::GetInstance().framePacer->GetStats();
+    return { stats.averageMs, stats.stddevMs, stats.minMs, stats.maxMs };
+}
+
+/**
+ * @brief Writes the profiler events recorded so far as a Chrome trace
+ * @param path Destination JSON file
+ * @return False if the file could not be written or the profiler is not built in
+ *
+ * @note Can be called from Lua as: write_trace("trace.json")
+ */
+bool WriteTrace(const std::string& path) {
+#ifdef ENABLE_PROFILER
+    return Profiler::GetInstance().WriteChromeTrace(path);
+#else
+    std::cerr << "[PROFILER] Built without ENABLE_PROFILER, " << path << " not written" << std::endl;
+    return false;
+#endif
+}
+
 /**
  * @brief Gets the current position of the mouse
  * @return A pair containing the x and y coordinates of the mouse
@@ -561,8 +631,8 @@ Uint32 GetTime() {
  * @note Can be called from Lua as: x, y = get_mouse()
  */
 std::pair<int, int> GetMousePosition() {
-    int x, y;
-    SDL_GetMouseState(&x, &y);
+    // Read from the ControllerManager so replays see the recorded position
+    auto [x, y] = Game::GetInstance().controllerManager->GetMousePosition();
     return { x, y };
 }
 
@@ -583,6 +653,98 @@ void SetShadow(Entity entity, float r, float g, float b) {
     }
 }
 
+// Spatial Query Functions
+
+/**
+ * @brief Gets every entity whose box collider overlaps a rectangle
+ * @param x, y Top left corner of the rectangle
+ * @param w, h Size of the rectangle
+ * @return Array of entities in entity id order; ids of killed entities are reused, so this is not creation order
+ *
+ * @note Can be called from Lua as: entities = query_rect(x, y, w, h)
+ */
+sol::as_table_t<std::vector<Entity>> QueryRect(float x, float y, float w, float h) {
+    std::vector<Entity> entities;
+    Game::GetInstance().registry->GetSystem<BoxCollisionSystem>()
+        .QueryRect({ x, y, x + w, y + h }, entities);
+    return sol::as_table(std::move(entities));
+}
+
+/**
+ * @brief Gets every entity whose box collider is within a radius of a point
+ * @param x, y Center of the search
+ * @param radius Search radius in pixels
+ * @return Array of entities in entity id order; ids of killed entities are reused, so this is not creation order
+ *
+ * @note Can be called from Lua as: entities = query_radius(x, y, 200)
+ */
+sol::as_table_t<std::vector<Entity>> QueryRadius(float x, float y, float radius) {
+    std::vector<Entity> entities;
+    Game::GetInstance().registry->GetSystem<BoxCollisionSystem>()
+        .QueryRadius(glm::vec2(x, y), radius, entities);
+    return sol::as_table(std::move(entities));
+}
+
+/**
+ * @brief Gets every entity whose box collider is crossed by a line
+ * @param x1, y1 Start of the line
+ * @param x2, y2 End of the line
+ * @return Array of entities, closest to the start first
+ *
+ * @note Can be called from Lua as: hits = raycast(x1, y1, x2, y2)
+ */
+sol::as_table_t<std::vector<Entity>> Raycast(float x1, float y1, float x2, float y2) {
+    std::vector<Entity> entities;
+    Game::GetInstance().registry->GetSystem<BoxCollisionSystem>()
+        .Raycast(glm::vec2(x1, y1), glm::vec2(x2, y2), entities);
+    return sol::as_table(std::move(entities));
+}
+
+/**
+ * @brief Finds the closest entity with a tag within a radius of a point
+ * @param x, y Center of the search
+ * @param radius Search radius in pixels
+ * @param tag Tag to look for
+ * @return The closest entity, or nil if none was found
+ *
+ * @note Can be called from Lua as: enemy = nearest_with_tag(x, y, 200, "enemy")
+ */
+sol::optional<Entity> NearestWithTag(float x, float y, float radius, const std::string& tag) {
+    Entity nearest(0);
+    if (Game::GetInstance().registry->GetSystem<BoxCollisionSystem>()
+        .NearestWithTag(glm::vec2(x, y), radius, tag, nearest)) {
+        return nearest;
+    }
+    return sol::nullopt;
+}
+
+// Tilemap Functions
+
+/**
+ * @brief Changes a tile of the map; its chunk is baked again before the next draw
+ * @param layer Name of the tile layer in the Tiled map
+ * @param x, y Column and row of the tile
+ * @param tile Tiled gid of the new tile, flip bits included, 0 to clear it
+ * @return False if the layer or the tile does not exist
+ *
+ * @note Can be called from Lua as: set_tile("ground", 10, 4, 23)
+ */
+bool SetTile(const std::string& layer, int x, int y, unsigned int tile) {
+    return Game::GetInstance().tilemap->SetTile(layer, x, y, tile);
+}
+
+/**
+ * @brief Gets a tile of the map
+ * @param layer Name of the tile layer in the Tiled map
+ * @param x, y Column and row of the tile
+ * @return Tiled gid of the tile, 0 if empty or outside the map
+ *
+ * @note Can be called from Lua as: tile = get_tile("ground", 10, 4)
+ */
+unsigned int GetTile(const std::string& layer, int x, int y) {
+    return Game::GetInstance().tilemap->GetTile(layer, x, y);
+}
+
 #endif // LUABINDING_HPP
 
 /** @} */ // end of LuaBinding group
\ No newline at end of file
@@ -11,7 +11,6 @@
 #define PROPERTYCOMPONENT_HPP
 
 #include <string>
-#include <SDL2/SDL.h>
 
  /**
   * @brief Represents a component that assigns a tag or property to an entity.
@@ -22,6 +22,7 @@
 struct RigidBodyComponent {
     bool isDynamic;
     bool isSolid;
+    bool isBullet; /**< Always swept against static solids to avoid tunneling */
 
     glm::vec2 sumForces = glm::vec2(0);
     glm::vec2 acceleration = glm::vec2(0);
@@ -30,21 +31,34 @@ struct RigidBodyComponent {
     float mass;
     float invMass;
 
+    bool isSleeping = false; /**< Resting body skipped by gravity, integration and narrowphase */
+    float sleepTimer = 0.0f; /**< Seconds the body has been below the sleep speed */
+
     /**
      * @brief Constructs a RigidBodyComponent with specified physical properties.
      *
      * @param isDynamic Indicates whether the rigid body is dynamic (can move). Default is `false`.
      * @param isSolid Indicates whether the rigid body is solid (interacts with other objects). Default is `false`.
      * @param mass The mass of the rigid body. Must be greater than 0. Default is `1`.
+     * @param isBullet Indicates whether the body is always checked with continuous collision. Default is `false`.
      */
     RigidBodyComponent(bool isDynamic = false, bool isSolid = false,
-        float mass = 1) {
+        float mass = 1, bool isBullet = false) {
         this->isDynamic = isDynamic;
         this->isSolid = isSolid;
+        this->isBullet = isBullet;
         this->mass = mass;
         this->invMass = 1 / mass;
 
     }
+
+    /**
+     * @brief Wakes the body so it is simulated again from the next update.
+     */
+    void WakeUp() {
+        isSleeping = false;
+        sleepTimer = 0.0f;
+    }
 };
 
 #endif // RIGIDBODYCOMPONENT_HPP
@@ -23,6 +23,11 @@ struct ScriptComponent {
     sol::function onCollision; /**< Lua function called when the entity collides with another. */
     sol::function onClick;     /**< Lua function called when the entity is clicked. */
     sol::function update;      /**< Lua function called during the entity's update cycle. */
+    sol::function onCollisionEnter; /**< Lua function called on the first step a box contact touches. */
+    sol::function onCollisionExit;  /**< Lua function called on the first step a box contact stops touching. */
+    sol::function onCollisions;     /**< Lua function called once per step with every box contact, replaces onCollision. */
+    sol::table collisionList;       /**< Array reused for the onCollisions argument, created on first use. */
+    int collisionListSize = 0;      /**< Entries written in collisionList by the last call. */
 
     /**
      * @brief Constructs a ScriptComponent with specified Lua functions.
@@ -30,13 +35,22 @@ struct ScriptComponent {
      * @param onCollision The Lua function for handling collision events (default is nil).
      * @param onClick The Lua function for handling click events (default is nil).
      * @param update The Lua function for handling update cycles (default is nil).
+     * @param onCollisionEnter The Lua function for contacts that begin (default is nil).
+     * @param onCollisionExit The Lua function for contacts that end (default is nil).
+     * @param onCollisions The Lua function receiving all the contacts of a step at once (default is nil).
      */
     ScriptComponent(sol::function onCollision = sol::lua_nil,
         sol::function onClick = sol::lua_nil,
-        sol::function update = sol::lua_nil) {
+        sol::function update = sol::lua_nil,
+        sol::function onCollisionEnter = sol::lua_nil,
+        sol::function onCollisionExit = sol::lua_nil,
+        sol::function onCollisions = sol::lua_nil) {
         this->onCollision = onCollision;
         this->onClick = onClick;
         this->update = update;
+        this->onCollisionEnter = onCollisionEnter;
+        this->onCollisionExit = onCollisionExit;
+        this->onCollisions = onCollisions;
     }
 };
 
@@ -0,0 +1,33 @@
+/**
+ * @file TileLayerComponent.hpp
+ * @brief Defines the TileLayerComponent marking where a baked tile layer is drawn.
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup Component
+ */
+
+#ifndef TILELAYERCOMPONENT_HPP
+#define TILELAYERCOMPONENT_HPP
+
+ /**
+  * @brief Represents a component that stands for a whole baked tile layer.
+  *
+  * The SceneLoader creates one entity with this component per baked layer,
+  * where the layer's tile entities would have been created, so the
+  * RenderSystem draws the layer's chunks at the same point of the draw
+  * order the tiles had.
+  */
+struct TileLayerComponent {
+    int layer; /**< Index of the layer in the Tilemap. */
+
+    /**
+     * @brief Constructs a TileLayerComponent for a layer.
+     *
+     * @param layer The index of the layer in the Tilemap (default is 0).
+     */
+    TileLayerComponent(int layer = 0) {
+        this->layer = layer;
+    }
+};
+
+#endif // TILELAYERCOMPONENT_HPP
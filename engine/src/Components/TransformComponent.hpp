@@ -44,6 +44,15 @@ struct TransformComponent {
         this->rotation = rotation;
         this->cameraFree = cameraFree;
     }
+
+    /**
+     * @brief Gets the position between previousPosition and position.
+     *
+     * @param alpha 0 for previousPosition, 1 for position.
+     */
+    glm::vec2 GetInterpolatedPosition(float alpha) const {
+        return previousPosition + (position - previousPosition) * alpha;
+    }
 };
 
 #endif // TRANSFORMCOMPONENT_HPP
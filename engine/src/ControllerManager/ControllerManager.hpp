@@ -32,8 +32,8 @@ private:
     std::map<std::string, int> mouseButtonName; ///< Maps mouse button names to their corresponding button codes.
     std::map<int, bool> mouseButtonDown; ///< Tracks the state (pressed or not) of mouse buttons.
 
-    int mousePosX; ///< The current X-coordinate of the mouse position.
-    int mousePosY; ///< The current Y-coordinate of the mouse position.
+    int mousePosX = 0; ///< The current X-coordinate of the mouse position.
+    int mousePosY = 0; ///< The current Y-coordinate of the mouse position.
 
 public:
     /**
@@ -0,0 +1,244 @@
+#include "InputRecorder.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+InputRecorder::InputRecorder() {
+}
+
+InputRecorder::~InputRecorder() {
+	Stop();
+}
+
+// Binary helpers, little endian
+void InputRecorder::WriteU8(uint8_t value) {
+	output.put(static_cast<char>(value));
+}
+
+void InputRecorder::WriteI16(int16_t value) {
+	uint16_t bits = static_cast<uint16_t>(value);
+	WriteU8(static_cast<uint8_t>(bits & 0xFF));
+	WriteU8(static_cast<uint8_t>(bits >> 8));
+}
+
+void InputRecorder::WriteI32(int32_t value) {
+	uint32_t bits = static_cast<uint32_t>(value);
+	for (int shift = 0; shift < 32; shift += 8) {
+		WriteU8(static_cast<uint8_t>((bits >> shift) & 0xFF));
+	}
+}
+
+bool InputRecorder::ReadU8(uint8_t& value) {
+	char byte;
+	if (!input.get(byte)) {
+		return false;
+	}
+	value = static_cast<uint8_t>(byte);
+	return true;
+}
+
+bool InputRecorder::ReadI16(int16_t& value) {
+	uint8_t low, high;
+	if (!ReadU8(low) || !ReadU8(high)) {
+		return false;
+	}
+	value = static_cast<int16_t>(static_cast<uint16_t>(low | (high << 8)));
+	return true;
+}
+
+bool InputRecorder::ReadI32(int32_t& value) {
+	uint32_t bits = 0;
+	for (int shift = 0; shift < 32; shift += 8) {
+		uint8_t byte;
+		if (!ReadU8(byte)) {
+			return false;
+		}
+		bits |= static_cast<uint32_t>(byte) << shift;
+	}
+	value = static_cast<int32_t>(bits);
+	return true;
+}
+
+bool InputRecorder::StartRecording(const std::string& path) {
+	Stop();
+	output.open(path, std::ios::binary | std::ios::trunc);
+	if (!output) {
+		std::cerr << "[INPUTRECORDER] Could not create " << path << std::endl;
+		return false;
+	}
+
+	output.write("SEIR", 4);
+	WriteU8(VERSION);
+	isRecording = true;
+	frameCount = 0;
+	std::cout << "[INPUTRECORDER] Recording input to " << path << std::endl;
+	return true;
+}
+
+bool InputRecorder::StartReplay(const std::string& path) {
+	Stop();
+	input.open(path, std::ios::binary);
+	if (!input) {
+		std::cerr << "[INPUTRECORDER] Could not open " << path << std::endl;
+		return false;
+	}
+
+	char magic[4];
+	uint8_t version = 0;
+	if (!input.read(magic, 4) || !std::equal(magic, magic + 4, "SEIR")
+		|| !ReadU8(version) || version != VERSION) {
+		std::cerr << "[INPUTRECORDER] " << path << " is not an input recording" << std::endl;
+		input.close();
+		return false;
+	}
+
+	isReplaying = true;
+	frameCount = 0;
+	std::cout << "[INPUTRECORDER] Replaying input from " << path << std::endl;
+	return true;
+}
+
+void InputRecorder::Stop() {
+	if (isRecording) {
+		output.close();
+		std::cout << "[INPUTRECORDER] Recorded " << frameCount << " frames" << std::endl;
+	}
+	if (isReplaying) {
+		input.close();
+		std::cout << "[INPUTRECORDER] Replayed " << frameCount << " frames" << std::endl;
+	}
+	isRecording = false;
+	isReplaying = false;
+}
+
+bool InputRecorder::IsRecording() const {
+	return isRecording;
+}
+
+bool InputRecorder::IsReplaying() const {
+	return isReplaying;
+}
+
+bool InputRecorder::FromSdlEvent(const SDL_Event& sdlEvent, InputEvent& event) {
+	switch (sdlEvent.type) {
+	case SDL_QUIT:
+		event.type = InputEventType::Quit;
+		return true;
+	case SDL_KEYDOWN:
+	case SDL_KEYUP:
+		event.type = sdlEvent.type == SDL_KEYDOWN ? InputEventType::KeyDown : InputEventType::KeyUp;
+		event.code = sdlEvent.key.keysym.sym;
+		return true;
+	case SDL_MOUSEMOTION:
+		event.type = InputEventType::MouseMotion;
+		event.x = static_cast<int16_t>(sdlEvent.motion.x);
+		event.y = static_cast<int16_t>(sdlEvent.motion.y);
+		return true;
+	case SDL_MOUSEBUTTONDOWN:
+	case SDL_MOUSEBUTTONUP:
+		event.type = sdlEvent.type == SDL_MOUSEBUTTONDOWN
+			? InputEventType::MouseButtonDown : InputEventType::MouseButtonUp;
+		event.code = sdlEvent.button.button;
+		event.x = static_cast<int16_t>(sdlEvent.button.x);
+		event.y = static_cast<int16_t>(sdlEvent.button.y);
+		return true;
+	default:
+		return false;
+	}
+}
+
+void InputRecorder::RecordEvent(const InputEvent& event) {
+	if (!isRecording) {
+		return;
+	}
+
+	WriteU8(static_cast<uint8_t>(event.type));
+	switch (event.type) {
+	case InputEventType::KeyDown:
+	case InputEventType::KeyUp:
+		WriteI32(event.code);
+		break;
+	case InputEventType::MouseMotion:
+		WriteI16(event.x);
+		WriteI16(event.y);
+		break;
+	case InputEventType::MouseButtonDown:
+	case InputEventType::MouseButtonUp:
+		WriteU8(static_cast<uint8_t>(event.code));
+		WriteI16(event.x);
+		WriteI16(event.y);
+		break;
+	default:
+		break;
+	}
+}
+
+void InputRecorder::EndFrame(int steps) {
+	if (!isRecording) {
+		return;
+	}
+
+	WriteU8(static_cast<uint8_t>(InputEventType::EndFrame));
+	WriteU8(static_cast<uint8_t>(std::min(std::max(steps, 0), 255)));
+	frameCount++;
+}
+
+bool InputRecorder::ReadFrame(std::vector<InputEvent>& events, int& steps) {
+	events.clear();
+	if (!isReplaying) {
+		return false;
+	}
+
+	while (true) {
+		uint8_t type;
+		if (!ReadU8(type)) {
+			break;
+		}
+
+		InputEvent event;
+		event.type = static_cast<InputEventType>(type);
+		bool isValid = true;
+		switch (event.type) {
+		case InputEventType::EndFrame: {
+			uint8_t frameSteps;
+			if (!ReadU8(frameSteps)) {
+				isValid = false;
+				break;
+			}
+			steps = frameSteps;
+			frameCount++;
+			return true;
+		}
+		case InputEventType::KeyDown:
+		case InputEventType::KeyUp:
+			isValid = ReadI32(event.code);
+			break;
+		case InputEventType::MouseMotion:
+			isValid = ReadI16(event.x) && ReadI16(event.y);
+			break;
+		case InputEventType::MouseButtonDown:
+		case InputEventType::MouseButtonUp: {
+			uint8_t button;
+			isValid = ReadU8(button) && ReadI16(event.x) && ReadI16(event.y);
+			event.code = button;
+			break;
+		}
+		case InputEventType::Quit:
+			break;
+		default:
+			std::cerr << "[INPUTRECORDER] Unknown record " << static_cast<int>(type) << std::endl;
+			isValid = false;
+			break;
+		}
+
+		if (!isValid) {
+			break;
+		}
+		events.push_back(event);
+	}
+
+	// End of the recording, or a truncated last frame
+	events.clear();
+	Stop();
+	return false;
+}
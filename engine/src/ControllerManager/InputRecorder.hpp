@@ -0,0 +1,153 @@
+/**
+ * @file InputRecorder.hpp
+ * @brief Records input to a binary file and plays it back
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup ControllerManagement
+ */
+
+#ifndef INPUTRECORDER_HPP
+#define INPUTRECORDER_HPP
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Kinds of input kept by the InputRecorder.
+ */
+enum class InputEventType : uint8_t {
+    EndFrame = 0,        /**< Closes a frame, only used in the file */
+    KeyDown = 1,         /**< Key pressed */
+    KeyUp = 2,           /**< Key released */
+    MouseMotion = 3,     /**< Mouse moved */
+    MouseButtonDown = 4, /**< Mouse button pressed */
+    MouseButtonUp = 5,   /**< Mouse button released */
+    Quit = 6             /**< Window closed */
+};
+
+/**
+ * @brief One input event, independent of SDL.
+ */
+struct InputEvent {
+    InputEventType type = InputEventType::Quit; /**< Kind of event */
+    int32_t code = 0; /**< Key code or mouse button */
+    int16_t x = 0; /**< Mouse x */
+    int16_t y = 0; /**< Mouse y */
+};
+
+/**
+ * @class InputRecorder
+ * @brief Saves the input of every frame and feeds it back on replay.
+ *
+ * The file starts with the "SEIR" magic and a version byte, followed by
+ * the events of each frame and an end of frame record holding the number
+ * of simulation steps that frame ran. Records are little endian:
+ * - keys: type, 4 byte key code
+ * - mouse motion: type, 2 byte x, 2 byte y
+ * - mouse buttons: type, 1 byte button, 2 byte x, 2 byte y
+ * - quit: type
+ * - end of frame: type, 1 byte step count
+ *
+ * A frame without input takes two bytes. Replaying runs the same steps
+ * per frame as the recording, so the simulation sees the same input at
+ * the same tick.
+ */
+class InputRecorder {
+private:
+    /** @brief File format version */
+    static constexpr uint8_t VERSION = 1;
+
+    std::ofstream output; ///< File being recorded.
+    std::ifstream input; ///< File being replayed.
+    bool isRecording = false; ///< True while recording.
+    bool isReplaying = false; ///< True while replaying.
+    int frameCount = 0; ///< Frames recorded or replayed.
+
+    /** @brief Writes one byte to the recording */
+    void WriteU8(uint8_t value);
+
+    /** @brief Writes a 2 byte little endian integer to the recording */
+    void WriteI16(int16_t value);
+
+    /** @brief Writes a 4 byte little endian integer to the recording */
+    void WriteI32(int32_t value);
+
+    /** @brief Reads one byte from the replay, false at the end of the file */
+    bool ReadU8(uint8_t& value);
+
+    /** @brief Reads a 2 byte little endian integer from the replay */
+    bool ReadI16(int16_t& value);
+
+    /** @brief Reads a 4 byte little endian integer from the replay */
+    bool ReadI32(int32_t& value);
+
+public:
+    /**
+     * @brief Constructs an idle InputRecorder.
+     */
+    InputRecorder();
+
+    /**
+     * @brief Closes any open file.
+     */
+    ~InputRecorder();
+
+    /**
+     * @brief Starts writing the input to a file.
+     * @param path Destination file, overwritten.
+     * @return False if the file could not be created.
+     */
+    bool StartRecording(const std::string& path);
+
+    /**
+     * @brief Starts reading the input from a file.
+     * @param path Recorded file.
+     * @return False if the file could not be opened or is not a recording.
+     */
+    bool StartReplay(const std::string& path);
+
+    /**
+     * @brief Closes the file and returns to live input.
+     */
+    void Stop();
+
+    /**
+     * @brief Checks whether input is being recorded.
+     */
+    bool IsRecording() const;
+
+    /**
+     * @brief Checks whether input is being replayed.
+     */
+    bool IsReplaying() const;
+
+    /**
+     * @brief Converts an SDL event to an InputEvent.
+     * @return False for events the engine does not handle.
+     */
+    static bool FromSdlEvent(const SDL_Event& sdlEvent, InputEvent& event);
+
+    /**
+     * @brief Adds an event to the current frame, does nothing unless recording.
+     */
+    void RecordEvent(const InputEvent& event);
+
+    /**
+     * @brief Closes the current frame, does nothing unless recording.
+     * @param steps Simulation steps run by the frame.
+     */
+    void EndFrame(int steps);
+
+    /**
+     * @brief Reads the next recorded frame.
+     * @param events Output events of the frame, cleared before use.
+     * @param steps Output simulation steps run by the frame.
+     * @return False at the end of the recording, which stops the replay.
+     */
+    bool ReadFrame(std::vector<InputEvent>& events, int& steps);
+};
+
+#endif // INPUTRECORDER_HPP
@@ -14,18 +14,28 @@ void Entity::Kill() {
 
 void System::AddEntityToSystem(Entity entity) {
 	entities.push_back(entity);
+	entityVersion++;
 }
 
 void System::RemoveEntityFromSystem(Entity entity) {
 	auto it = std::remove_if(entities.begin(), entities.end()
 		, [&entity](Entity other){ return entity == other; });
 	entities.erase(it, entities.end()); 
+	entityVersion++;
 }
 
 std::vector<Entity> System::GetSystemEntities() const {
 	return entities;
 }
 
+int System::GetEntityCount() const {
+	return static_cast<int>(entities.size());
+}
+
+unsigned int System::GetEntityVersion() const {
+	return entityVersion;
+}
+
 const Signature& System::GetComponentSignature() const {
 	return componentSignature;
 }
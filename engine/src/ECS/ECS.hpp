@@ -122,6 +122,7 @@ class System {
 private:
     Signature componentSignature; /**< Signature indicating required components */
     std::vector<Entity> entities; /**< List of entities associated with the system */
+    unsigned int entityVersion = 0; /**< Bumped whenever an entity is added or removed */
 
 public:
     System() = default;
@@ -145,6 +146,19 @@ public:
      */
     std::vector<Entity> GetSystemEntities() const;
 
+    /**
+     * @brief Gets the number of entities associated with the system.
+     * @return The entity count, without copying the entity list.
+     */
+    int GetEntityCount() const;
+
+    /**
+     * @brief Gets a counter that changes whenever the entity list changes.
+     * @return The version, compare it with a saved one to know if data built
+     *         from the entity list is stale.
+     */
+    unsigned int GetEntityVersion() const;
+
     /**
      * @brief Gets the component signature for the system.
      * @return The component signature.
@@ -304,11 +318,13 @@ void Registry::AddComponent(Entity entity, TArgs&& ... args) {
     std::shared_ptr<Pool<TComponent>> componentPool
         = std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
 
+    // Built before resizing, args may reference a component of this pool
+    TComponent newComponent(std::forward<TArgs>(args)...);
+
     if (entityId >= componentPool->GetSize()) {
         componentPool->Resize(numEntity + 100);
     }
 
-    TComponent newComponent(std::forward<TArgs>(args)...);
     componentPool->Set(entityId, newComponent);
     entityComponentSignatures[entityId].set(componentId);
 }
@@ -354,8 +370,8 @@ template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const {
     const int componentId = Component<TComponent>::GetId();
     const int entityId = entity.GetId();
-    auto componentPool
-        = std::static_pointer_cast<Pool<TComponent>>(componentsPools[componentId]);
+    // A plain cast, copying the shared_ptr would touch its atomic count on every call
+    auto componentPool = static_cast<Pool<TComponent>*>(componentsPools[componentId].get());
     return componentPool->Get(entityId);
 }
 
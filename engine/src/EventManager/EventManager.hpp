@@ -11,12 +11,12 @@
 #ifndef EVENTMANAGER_HPP
 #define EVENTMANAGER_HPP
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
-#include <list>
-#include <map>
 #include <memory>
-#include <typeindex>
+#include <vector>
 
 #include "Event.hpp"
 
@@ -92,20 +92,503 @@ public:
 };
 
 /**
- * @brief Alias for a list of event handlers.
+ * @brief Base of the event type ids, holds the next free id.
  */
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+struct IEventType {
+protected:
+    static inline int nextId = 0; /**< Next free event type id */
+};
+
+/**
+ * @brief Gives every event type a small dense id.
+ *
+ * The EventManager indexes its handler lists and queues with these ids
+ * instead of looking the type up in a map.
+ *
+ * @tparam TEvent The type of the event.
+ */
+template <typename TEvent>
+class EventType : public IEventType {
+public:
+    /**
+     * @brief Gets the unique ID for the event type.
+     */
+    static int GetId() {
+        static int id = nextId++;
+        return id;
+    }
+};
+
+/**
+ * @brief Read only view of the events of one type queued during a frame.
+ *
+ * @tparam TEvent The type of the event.
+ */
+template <typename TEvent>
+struct EventSpan {
+    const TEvent* data = nullptr; ///< First event.
+    size_t count = 0;             ///< Number of events.
+
+    const TEvent* begin() const { return data; }
+    const TEvent* end() const { return data + count; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const TEvent& operator[](size_t index) const { return data[index]; }
+};
+
+/**
+ * @brief Interface for callbacks receiving a batch of queued events.
+ *
+ * @tparam TEvent The type of the event.
+ */
+template <typename TEvent>
+class IBatchCallback {
+public:
+    /**
+     * @brief Virtual destructor for the IBatchCallback class.
+     */
+    virtual ~IBatchCallback() = default;
+
+    /**
+     * @brief Executes the callback for every queued event at once.
+     *
+     * @param events The events queued since the last dispatch.
+     */
+    virtual void Execute(const EventSpan<TEvent>& events) = 0;
+};
+
+/**
+ * @brief Binds a member function of an owner class to batches of queued events.
+ *
+ * @tparam TOwner The type of the owner class.
+ * @tparam TEvent The type of the event.
+ */
+template <typename TOwner, typename TEvent>
+class BatchCallback : public IBatchCallback<TEvent> {
+private:
+    typedef void (TOwner::* CallbackFunction)(const EventSpan<TEvent>&);
+
+    TOwner* ownerInstance;            ///< Pointer to the instance of the owner class.
+    CallbackFunction callbackFunction; ///< The member function to call with the batch.
+
+public:
+    /**
+     * @brief Constructs a BatchCallback.
+     *
+     * @param ownerInstance Pointer to the owner class instance.
+     * @param callbackFunction The member function to call with the batch.
+     */
+    BatchCallback(TOwner* ownerInstance, CallbackFunction callbackFunction)
+        : ownerInstance(ownerInstance), callbackFunction(callbackFunction) {}
+
+    /**
+     * @brief Calls the callback function with the batch.
+     *
+     * @param events The events queued since the last dispatch.
+     */
+    void Execute(const EventSpan<TEvent>& events) override {
+        std::invoke(callbackFunction, ownerInstance, events);
+    }
+};
+
+/**
+ * @brief Identifies one subscription, returned by EventManager::SubscribeToEvent
+ * and EventManager::SubscribeToBatch.
+ *
+ * A default constructed handle refers to no subscription and is ignored by
+ * EventManager::Unsubscribe.
+ */
+struct EventHandle {
+    int type = -1;       ///< EventType id of the subscription.
+    unsigned int id = 0; ///< Subscription id, 0 for none.
+
+    /**
+     * @brief Checks whether the handle refers to a subscription.
+     */
+    bool IsValid() const {
+        return id != 0;
+    }
+};
+
+/**
+ * @brief Callbacks of one event type, in subscription order.
+ *
+ * Callbacks live in a vector so dispatching walks contiguous memory.
+ * Callbacks removed while the list is being walked are only nulled, and the
+ * vector is compacted once the outermost walk returns.
+ *
+ * @tparam TCallback The callback interface stored.
+ */
+template <typename TCallback>
+struct SubscriberList {
+    /**
+     * @brief One subscribed callback.
+     */
+    struct Subscriber {
+        unsigned int id = 0; ///< Subscription id.
+        std::unique_ptr<TCallback> callback; ///< Callback, null once unsubscribed.
+    };
+
+    std::vector<Subscriber> subscribers; ///< Callbacks in subscription order.
+    int walkDepth = 0; ///< Walks of this list in progress.
+    bool hasRemoved = false; ///< True when nulled callbacks wait for compaction.
+
+    /**
+     * @brief Drops the callbacks unsubscribed during a walk.
+     */
+    void Compact() {
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+            [](const Subscriber& subscriber) { return subscriber.callback == nullptr; }),
+            subscribers.end());
+        hasRemoved = false;
+    }
+
+    /**
+     * @brief Removes a subscription.
+     * @return False if the id is not in this list.
+     */
+    bool Remove(unsigned int id) {
+        for (auto& subscriber : subscribers) {
+            if (subscriber.id != id) {
+                continue;
+            }
+            subscriber.callback.reset();
+            if (walkDepth > 0) {
+                hasRemoved = true;
+            }
+            else {
+                Compact();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Calls a function with every live callback.
+     *
+     * Callbacks added during the walk are first visited by the next one.
+     */
+    template <typename TFunction>
+    void ForEach(TFunction&& function) {
+        // Indexes stay valid if a callback subscribes and the vector grows
+        size_t count = subscribers.size();
+        walkDepth++;
+        for (size_t i = 0; i < count; i++) {
+            TCallback* callback = subscribers[i].callback.get();
+            if (callback != nullptr) {
+                function(*callback);
+            }
+        }
+        walkDepth--;
+
+        if (walkDepth == 0 && hasRemoved) {
+            Compact();
+        }
+    }
+};
+
+/**
+ * @brief Alias for the list of handlers of one event type.
+ */
+typedef SubscriberList<IEventCallback> HandlerList;
+
+/**
+ * @brief Interface of the queue of one event type.
+ */
+class IEventQueue {
+protected:
+    static inline std::atomic<unsigned long long> nextQueueId{ 1 }; /**< Next free queue id, never reused */
+
+public:
+    /**
+     * @brief Virtual destructor for the IEventQueue class.
+     */
+    virtual ~IEventQueue() = default;
+
+    /**
+     * @brief Delivers the queued events to the batch handlers, then to the handlers one by one.
+     *
+     * @param handlers Handlers of the same event type subscribed with SubscribeToEvent.
+     */
+    virtual void Dispatch(HandlerList& handlers) = 0;
+
+    /**
+     * @brief Removes a batch subscription.
+     * @return False if the id is not subscribed to this queue.
+     */
+    virtual bool Unsubscribe(unsigned int id) = 0;
+
+    /**
+     * @brief Drops the queued events without delivering them.
+     */
+    virtual void Clear() = 0;
+
+    /**
+     * @brief Checks whether the queue has batch handlers.
+     */
+    virtual bool HasBatchHandlers() const = 0;
+};
+
+/**
+ * @brief Events of one type queued during a frame, with their batch handlers.
+ *
+ * Events are appended to a vector and handed to every batch handler as one
+ * span. Events queued while the queue is dispatched go to the next dispatch.
+ *
+ * Worker threads queue with PushConcurrent. Every thread appends to its own
+ * staging buffer, found through a thread_local cache, so the hot path takes
+ * no lock and shares no cache line with other producers. A thread's buffer
+ * is created on its first push and linked into the queue with a
+ * compare-and-swap. Dispatch merges the staging buffers, ordered by the key
+ * given to each push and then by push order within the thread, so the
+ * result does not depend on thread scheduling as long as each key is only
+ * used by one thread at a time; a JobPool chunk index is such a key.
+ *
+ * No engine system pushes from workers yet: collision events come from the
+ * contact pair cache on the main thread. bench/EventQueueBench.cpp drives
+ * PushConcurrent from JobPool chunks and fails if the merged order differs
+ * from a single threaded run.
+ *
+ * @tparam TEvent The type of the event.
+ */
+template <typename TEvent>
+class EventQueue : public IEventQueue {
+private:
+    /**
+     * @brief Event pushed by a worker thread, with its ordering key.
+     */
+    struct StagedEvent {
+        unsigned long long key; ///< Ordering key given to PushConcurrent.
+        size_t sequence; ///< Push order within the staging buffer.
+        TEvent event; ///< The event.
+    };
+
+    /**
+     * @brief Events pushed by one thread since the last merge.
+     */
+    struct StagingBuffer {
+        std::vector<StagedEvent> events; ///< Written by the owning thread only.
+        StagingBuffer* next = nullptr; ///< Next buffer of the queue.
+    };
+
+    /**
+     * @brief Staging buffer of the calling thread for one queue.
+     */
+    struct StagingSlot {
+        unsigned long long queueId; ///< Queue owning the buffer.
+        StagingBuffer* buffer; ///< Buffer of the calling thread.
+    };
+
+    std::vector<TEvent> pending; ///< Events queued since the last dispatch.
+    std::vector<TEvent> dispatching; ///< Events being delivered, reused between dispatches.
+    bool isDispatching = false; ///< True while the queue delivers its events.
+
+    const unsigned long long queueId = nextQueueId++; ///< Identifies the queue in the thread_local caches.
+    std::atomic<StagingBuffer*> stagingHead{ nullptr }; ///< Staging buffers of every producer thread.
+    std::vector<StagedEvent*> merged; ///< Scratch buffer used to order staged events.
+
+    /**
+     * @brief Gets the staging buffer of the calling thread, creating it on first use.
+     */
+    StagingBuffer& GetStagingBuffer() {
+        // Ids are never reused, so slots of destroyed queues are never matched
+        thread_local std::vector<StagingSlot> slots;
+        for (const auto& slot : slots) {
+            if (slot.queueId == queueId) {
+                return *slot.buffer;
+            }
+        }
+
+        StagingBuffer* buffer = new StagingBuffer();
+        buffer->next = stagingHead.load(std::memory_order_relaxed);
+        while (!stagingHead.compare_exchange_weak(buffer->next, buffer,
+            std::memory_order_release, std::memory_order_relaxed)) {
+        }
+        slots.push_back({ queueId, buffer });
+        return *buffer;
+    }
+
+    /**
+     * @brief Moves the staged events to the pending events in key order.
+     */
+    void MergeStaged() {
+        merged.clear();
+        for (StagingBuffer* buffer = stagingHead.load(std::memory_order_acquire);
+            buffer != nullptr; buffer = buffer->next) {
+            for (auto& staged : buffer->events) {
+                merged.push_back(&staged);
+            }
+        }
+        if (merged.empty()) {
+            return;
+        }
+
+        std::sort(merged.begin(), merged.end(), [](const StagedEvent* a, const StagedEvent* b) {
+            return a->key != b->key ? a->key < b->key : a->sequence < b->sequence;
+        });
+        for (StagedEvent* staged : merged) {
+            pending.push_back(std::move(staged->event));
+        }
+        merged.clear();
+        ClearStaged();
+    }
+
+    /**
+     * @brief Empties every staging buffer, keeping its capacity.
+     */
+    void ClearStaged() {
+        for (StagingBuffer* buffer = stagingHead.load(std::memory_order_acquire);
+            buffer != nullptr; buffer = buffer->next) {
+            buffer->events.clear();
+        }
+    }
+
+public:
+    SubscriberList<IBatchCallback<TEvent>> batchHandlers; ///< Handlers receiving whole spans.
+
+    EventQueue() = default;
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
+    /**
+     * @brief Frees the staging buffers, no thread may be pushing.
+     */
+    ~EventQueue() override {
+        StagingBuffer* buffer = stagingHead.load(std::memory_order_acquire);
+        while (buffer != nullptr) {
+            StagingBuffer* next = buffer->next;
+            delete buffer;
+            buffer = next;
+        }
+    }
+
+    /**
+     * @brief Appends an event to the queue, from the main thread only.
+     */
+    template <typename ...TArgs>
+    void Push(TArgs&& ... args) {
+        pending.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    /**
+     * @brief Appends an event from any thread, without locking.
+     *
+     * Must not run at the same time as Dispatch or Clear; JobPool::ParallelFor
+     * returning is the sync point.
+     *
+     * @param key Ordering key of the event in the merged queue, e.g. the JobPool chunk index.
+     * @param args The arguments used to construct the event.
+     */
+    template <typename ...TArgs>
+    void PushConcurrent(unsigned long long key, TArgs&& ... args) {
+        StagingBuffer& buffer = GetStagingBuffer();
+        buffer.events.push_back({ key, buffer.events.size(), TEvent(std::forward<TArgs>(args)...) });
+    }
+
+    void Dispatch(HandlerList& handlers) override {
+        if (isDispatching) {
+            return;
+        }
+        // Nobody listens, the events are dropped without ordering them
+        if (batchHandlers.subscribers.empty() && handlers.subscribers.empty()) {
+            Clear();
+            return;
+        }
+        MergeStaged();
+        if (pending.empty()) {
+            return;
+        }
+
+        isDispatching = true;
+        dispatching.swap(pending);
+        EventSpan<TEvent> events;
+        events.data = dispatching.data();
+        events.count = dispatching.size();
+
+        batchHandlers.ForEach([&](IBatchCallback<TEvent>& handler) {
+            handler.Execute(events);
+        });
+        if (!handlers.subscribers.empty()) {
+            for (const TEvent& queued : dispatching) {
+                handlers.ForEach([&](IEventCallback& handler) {
+                    TEvent event(queued);
+                    handler.Execute(event);
+                });
+            }
+        }
+
+        // Keeps the capacity for the next frame
+        dispatching.clear();
+        isDispatching = false;
+    }
+
+    bool Unsubscribe(unsigned int id) override {
+        return batchHandlers.Remove(id);
+    }
+
+    void Clear() override {
+        pending.clear();
+        ClearStaged();
+    }
+
+    bool HasBatchHandlers() const override {
+        return !batchHandlers.subscribers.empty();
+    }
+};
 
 /**
  * @brief Manages event subscription and emission.
  *
  * The EventManager class is responsible for managing event listeners and
- * notifying them when events are emitted. It supports subscribing to events
- * and emitting events to notify subscribers.
+ * notifying them when events are emitted. Subscriptions persist until they
+ * are removed with Unsubscribe or Reset, so systems subscribe once at setup
+ * and emitting allocates nothing.
+ *
+ * Events are either emitted, reaching every handler at once, or queued and
+ * delivered in bulk by DispatchQueued. Queued events reach batch handlers as
+ * one span per type, then handlers subscribed with SubscribeToEvent one by
+ * one, so a handler does not need to know how its event was sent.
+ *
+ * Only the main thread may emit, queue or subscribe. Code running on
+ * worker threads pushes to the queue returned by GetConcurrentQueue.
  */
 class EventManager {
 private:
-    std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers; ///< Map of event subscribers.
+    std::vector<std::unique_ptr<HandlerList>> subscribers; ///< Handlers indexed by EventType id, null until used.
+    std::vector<std::unique_ptr<IEventQueue>> queues; ///< Queues indexed by EventType id, null until used.
+    unsigned int nextId = 1; ///< Id of the next subscription.
+
+    /**
+     * @brief Gets the handlers of an event type, creating them on first use.
+     *
+     * Lists are heap allocated so a handler subscribing to a new type does
+     * not move the list being walked.
+     */
+    HandlerList& GetHandlers(int type) {
+        if (static_cast<size_t>(type) >= subscribers.size()) {
+            subscribers.resize(type + 1);
+        }
+        if (!subscribers[type]) {
+            subscribers[type] = std::make_unique<HandlerList>();
+        }
+        return *subscribers[type];
+    }
+
+    /**
+     * @brief Gets the queue of an event type, creating it on first use.
+     */
+    template <typename TEvent>
+    EventQueue<TEvent>& GetQueue() {
+        const int type = EventType<TEvent>::GetId();
+        if (static_cast<size_t>(type) >= queues.size()) {
+            queues.resize(type + 1);
+        }
+        if (!queues[type]) {
+            queues[type] = std::make_unique<EventQueue<TEvent>>();
+        }
+        return static_cast<EventQueue<TEvent>&>(*queues[type]);
+    }
 
 public:
     /**
@@ -127,12 +610,15 @@ public:
     }
 
     /**
-     * @brief Clears all event subscriptions.
+     * @brief Clears all event subscriptions and queued events.
      *
-     * Resets the EventManager, removing all subscribers.
+     * Resets the EventManager, removing all subscribers. Handles obtained
+     * before become stale and are ignored by Unsubscribe. Must not be
+     * called from a handler.
      */
     void Reset() {
         subscribers.clear();
+        queues.clear();
     }
 
     /**
@@ -142,21 +628,72 @@ public:
      * @tparam TOwner The type of the owner instance.
      * @param ownerInstance Pointer to the owner instance.
      * @param callbackFunction The member function to be called when the event is emitted.
+     * @return Handle used to unsubscribe. The owner must unsubscribe before it is destroyed.
      */
     template <typename TEvent, typename TOwner>
-    void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::* callbackFunction)(TEvent&)) {
-        if (!subscribers[typeid(TEvent)].get()) {
-            subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
-        }
+    EventHandle SubscribeToEvent(TOwner* ownerInstance, void (TOwner::* callbackFunction)(TEvent&)) {
+        EventHandle handle;
+        handle.type = EventType<TEvent>::GetId();
+        handle.id = nextId++;
 
-        auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-        subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
+        HandlerList::Subscriber subscriber;
+        subscriber.id = handle.id;
+        subscriber.callback = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
+        GetHandlers(handle.type).subscribers.push_back(std::move(subscriber));
+        return handle;
+    }
+
+    /**
+     * @brief Subscribes an owner instance to the queued events of a type, delivered as one span.
+     *
+     * Only events sent with QueueEvent reach batch handlers.
+     *
+     * @tparam TEvent The type of the event to subscribe to.
+     * @tparam TOwner The type of the owner instance.
+     * @param ownerInstance Pointer to the owner instance.
+     * @param callbackFunction The member function to be called with the queued events.
+     * @return Handle used to unsubscribe. The owner must unsubscribe before it is destroyed.
+     */
+    template <typename TEvent, typename TOwner>
+    EventHandle SubscribeToBatch(TOwner* ownerInstance,
+        void (TOwner::* callbackFunction)(const EventSpan<TEvent>&)) {
+        EventHandle handle;
+        handle.type = EventType<TEvent>::GetId();
+        handle.id = nextId++;
+
+        typename SubscriberList<IBatchCallback<TEvent>>::Subscriber subscriber;
+        subscriber.id = handle.id;
+        subscriber.callback = std::make_unique<BatchCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
+        GetQueue<TEvent>().batchHandlers.subscribers.push_back(std::move(subscriber));
+        return handle;
+    }
+
+    /**
+     * @brief Removes a subscription.
+     *
+     * Safe to call from a handler while its event is being delivered; the
+     * removed handler is not called again.
+     *
+     * @param handle Handle returned by SubscribeToEvent or SubscribeToBatch, invalid handles are ignored.
+     */
+    void Unsubscribe(const EventHandle& handle) {
+        if (!handle.IsValid()) {
+            return;
+        }
+        size_t type = static_cast<size_t>(handle.type);
+        if (type < subscribers.size() && subscribers[type] && subscribers[type]->Remove(handle.id)) {
+            return;
+        }
+        if (type < queues.size() && queues[type]) {
+            queues[type]->Unsubscribe(handle.id);
+        }
     }
 
     /**
      * @brief Emits an event, notifying all subscribers.
      *
      * Creates an event of type TEvent and invokes all subscribed callbacks for that event type.
+     * Handlers subscribed while the event is being emitted are first called by the next emission.
      *
      * @tparam TEvent The type of the event to emit.
      * @tparam TArgs The types of the arguments used to construct the event.
@@ -164,12 +701,84 @@ public:
      */
     template <typename TEvent, typename ...TArgs>
     void EmitEvent(TArgs&& ... args) {
-        auto handlers = subscribers[typeid(TEvent)].get();
-        if (handlers) {
-            for (auto it = handlers->begin(); it != handlers->end(); it++) {
-                auto handler = it->get();
-                TEvent event(std::forward<TArgs>(args)...);
-                handler->Execute(event);
+        const size_t type = static_cast<size_t>(EventType<TEvent>::GetId());
+        if (type >= subscribers.size() || !subscribers[type] || subscribers[type]->subscribers.empty()) {
+            return;
+        }
+
+        subscribers[type]->ForEach([&](IEventCallback& handler) {
+            TEvent event(args...);
+            handler.Execute(event);
+        });
+    }
+
+    /**
+     * @brief Checks whether any handler would receive an event of a type.
+     *
+     * Producers of frequent events can skip building them when this is false.
+     *
+     * @tparam TEvent The type of the event.
+     */
+    template <typename TEvent>
+    bool HasHandlers() const {
+        const size_t type = static_cast<size_t>(EventType<TEvent>::GetId());
+        if (type < subscribers.size() && subscribers[type] && !subscribers[type]->subscribers.empty()) {
+            return true;
+        }
+        return type < queues.size() && queues[type] && queues[type]->HasBatchHandlers();
+    }
+
+    /**
+     * @brief Queues an event, delivered by the next DispatchQueued.
+     *
+     * @tparam TEvent The type of the event to queue.
+     * @tparam TArgs The types of the arguments used to construct the event.
+     * @param args The arguments used to construct the event.
+     */
+    template <typename TEvent, typename ...TArgs>
+    void QueueEvent(TArgs&& ... args) {
+        GetQueue<TEvent>().Push(std::forward<TArgs>(args)...);
+    }
+
+    /**
+     * @brief Gets the queue of an event type so worker threads can push to it.
+     *
+     * Call from the main thread before the workers start; the queue stays
+     * valid until Reset. Workers then call EventQueue::PushConcurrent, while
+     * the main thread keeps using QueueEvent.
+     *
+     * @tparam TEvent The type of the event.
+     */
+    template <typename TEvent>
+    EventQueue<TEvent>& GetConcurrentQueue() {
+        return GetQueue<TEvent>();
+    }
+
+    /**
+     * @brief Delivers every queued event, one event type after another.
+     *
+     * Event types are delivered in the order of their EventType ids. Events
+     * queued by handlers are delivered by the next call. Events pushed
+     * with EventQueue::PushConcurrent are merged in after the ones queued
+     * by the main thread; no thread may be pushing during the call. Events of a type
+     * without handlers are dropped without being merged.
+     */
+    void DispatchQueued() {
+        // Handlers may queue a new type and grow the vector, so index it
+        for (size_t type = 0; type < queues.size(); type++) {
+            if (queues[type]) {
+                queues[type]->Dispatch(GetHandlers(static_cast<int>(type)));
+            }
+        }
+    }
+
+    /**
+     * @brief Drops every queued event without delivering it.
+     */
+    void ClearQueued() {
+        for (auto& queue : queues) {
+            if (queue) {
+                queue->Clear();
             }
         }
     }
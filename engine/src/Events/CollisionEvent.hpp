@@ -12,6 +12,14 @@
 #include "../ECS/ECS.hpp"
 #include "../EventManager/Event.hpp"
 
+/**
+ * @brief Stage of a box contact reported by a CollisionEvent.
+ */
+enum class ContactPhase {
+    Begin,    /**< First step the boxes overlap */
+    End       /**< First step the boxes no longer overlap */
+};
+
 /**
  * @brief Represents a collision event between two entities.
  *
@@ -30,13 +38,20 @@ public:
      */
     Entity b;
 
+    /**
+     * @brief Stage of the contact.
+     */
+    ContactPhase phase;
+
     /**
      * @brief Constructs a new CollisionEvent.
      *
      * @param a The first entity involved in the collision.
      * @param b The second entity involved in the collision.
+     * @param phase Stage of the contact.
      */
-    CollisionEvent(Entity a, Entity b) : a(a), b(b) {}
+    CollisionEvent(Entity a, Entity b, ContactPhase phase)
+        : a(a), b(b), phase(phase) {}
 };
 
 #endif // COLLISIONEVENT_HPP
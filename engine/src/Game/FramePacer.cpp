@@ -0,0 +1,137 @@
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+FramePacer::FramePacer() {
+	frequency = SDL_GetPerformanceFrequency();
+	frameTimes.assign(STATS_WINDOW, 0.0);
+	SetTargetRate(targetRate);
+}
+
+FramePacer::~FramePacer() {
+}
+
+void FramePacer::WaitUntil(Uint64 target) const {
+	Uint64 now = SDL_GetPerformanceCounter();
+	while (now < target) {
+		double remaining = static_cast<double>(target - now) / frequency;
+		if (remaining > SPIN_THRESHOLD) {
+			// Sleep most of the way, SDL_Delay may oversleep by a scheduler tick
+			SDL_Delay(static_cast<Uint32>((remaining - SPIN_THRESHOLD) * 1000.0));
+		}
+		now = SDL_GetPerformanceCounter();
+	}
+}
+
+void FramePacer::SetTargetRate(double fps) {
+	if (fps <= 0.0) {
+		mode = PacingMode::Uncapped;
+		return;
+	}
+	targetRate = fps;
+	frameTicks = static_cast<Uint64>(frequency / fps);
+	if (mode == PacingMode::Uncapped) {
+		mode = PacingMode::Target;
+	}
+	deadline = 0;
+}
+
+double FramePacer::GetTargetRate() const {
+	return targetRate;
+}
+
+void FramePacer::SetMode(PacingMode mode) {
+	this->mode = mode;
+	deadline = 0;
+}
+
+PacingMode FramePacer::GetMode() const {
+	return mode;
+}
+
+void FramePacer::Reset() {
+	deadline = 0;
+	previousFrame = 0;
+	frameTimeNext = 0;
+	frameCount = 0;
+}
+
+double FramePacer::WaitForNextFrame() {
+	if (mode == PacingMode::Target) {
+		if (deadline != 0) {
+			WaitUntil(deadline);
+		}
+
+		Uint64 now = SDL_GetPerformanceCounter();
+		if (deadline == 0 || now - deadline > frameTicks) {
+			// First frame or too far behind, restart the schedule from now
+			deadline = now + frameTicks;
+		}
+		else {
+			deadline += frameTicks;
+		}
+	}
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (previousFrame == 0) {
+		previousFrame = now;
+		return 0.0;
+	}
+
+	double elapsed = static_cast<double>(now - previousFrame) / frequency;
+	previousFrame = now;
+
+	frameTimes[frameTimeNext] = elapsed * 1000.0;
+	frameTimeNext = (frameTimeNext + 1) % STATS_WINDOW;
+	frameCount++;
+	return elapsed;
+}
+
+FrameStats FramePacer::GetStats() const {
+	FrameStats stats;
+	stats.frameCount = frameCount;
+	int count = std::min(frameCount, STATS_WINDOW);
+	if (count == 0) {
+		return stats;
+	}
+
+	double sum = 0.0;
+	stats.minMs = frameTimes[0];
+	stats.maxMs = frameTimes[0];
+	for (int i = 0; i < count; i++) {
+		sum += frameTimes[i];
+		stats.minMs = std::min(stats.minMs, frameTimes[i]);
+		stats.maxMs = std::max(stats.maxMs, frameTimes[i]);
+	}
+	stats.averageMs = sum / count;
+
+	double variance = 0.0;
+	for (int i = 0; i < count; i++) {
+		double difference = frameTimes[i] - stats.averageMs;
+		variance += difference * difference;
+	}
+	stats.stddevMs = std::sqrt(variance / count);
+
+	// Nearest rank percentiles
+	std::vector<double> sorted(frameTimes.begin(), frameTimes.begin() + count);
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](double p) {
+		int rank = static_cast<int>(std::ceil(p * count)) - 1;
+		return sorted[std::min(std::max(rank, 0), count - 1)];
+	};
+	stats.p50Ms = percentile(0.50);
+	stats.p95Ms = percentile(0.95);
+	stats.p99Ms = percentile(0.99);
+	return stats;
+}
+
+void FramePacer::GetFrameTimes(std::vector<double>& result) const {
+	result.clear();
+	int count = std::min(frameCount, STATS_WINDOW);
+	// Before the buffer wraps the oldest frame is in slot 0
+	int oldest = frameCount < STATS_WINDOW ? 0 : frameTimeNext;
+	for (int i = 0; i < count; i++) {
+		result.push_back(frameTimes[(oldest + i) % STATS_WINDOW]);
+	}
+}
@@ -0,0 +1,132 @@
+/**
+ * @file FramePacer.hpp
+ * @brief High resolution frame rate limiter and frame time statistics
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup MainFlow
+ */
+
+#ifndef FRAMEPACER_HPP
+#define FRAMEPACER_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+/**
+ * @brief How the FramePacer decides when the next frame starts
+ */
+enum class PacingMode {
+    Target,   /**< Wait until the target frame duration has elapsed */
+    Uncapped, /**< Never wait, run as fast as possible */
+    Vsync     /**< Never wait, SDL_RenderPresent blocks on the display refresh */
+};
+
+/**
+ * @brief Frame time statistics over the most recent frames
+ */
+struct FrameStats {
+    int frameCount = 0;      /**< Frames measured since the last Reset */
+    double averageMs = 0.0;  /**< Mean frame time */
+    double stddevMs = 0.0;   /**< Standard deviation of the frame time */
+    double minMs = 0.0;      /**< Shortest frame */
+    double maxMs = 0.0;      /**< Longest frame */
+    double p50Ms = 0.0;      /**< Median frame time */
+    double p95Ms = 0.0;      /**< 95th percentile frame time */
+    double p99Ms = 0.0;      /**< 99th percentile frame time */
+};
+
+/**
+ * @class FramePacer
+ * @brief Paces the main loop with the SDL performance counter.
+ *
+ * In Target mode every frame has a deadline one frame duration after the
+ * previous one. The pacer sleeps with SDL_Delay while the deadline is
+ * further away than the scheduler can be trusted with, then spins for the
+ * rest, which keeps the jitter well under a millisecond. Deadlines advance
+ * by whole frame durations so rounding does not drift the rate; a frame
+ * that overruns by more than one duration restarts the schedule instead of
+ * running a burst of short frames.
+ */
+class FramePacer {
+private:
+    /** @brief Remaining time under which the pacer spins instead of sleeping */
+    static constexpr double SPIN_THRESHOLD = 0.002;
+
+    /** @brief Frames kept for the statistics */
+    static constexpr int STATS_WINDOW = 240;
+
+    PacingMode mode = PacingMode::Target; ///< Current pacing mode.
+    double targetRate = 60.0; ///< Frames per second in Target mode.
+    Uint64 frequency = 0; ///< Performance counter ticks per second.
+    Uint64 frameTicks = 0; ///< Target frame duration in counter ticks.
+    Uint64 deadline = 0; ///< Counter value at which the next frame may start.
+    Uint64 previousFrame = 0; ///< Counter value at the start of the previous frame, 0 after Reset.
+
+    std::vector<double> frameTimes; ///< Ring buffer of recent frame times in milliseconds.
+    int frameTimeNext = 0; ///< Next slot written in frameTimes.
+    int frameCount = 0; ///< Frames measured since the last Reset.
+
+    /**
+     * @brief Blocks until the performance counter reaches a value.
+     */
+    void WaitUntil(Uint64 target) const;
+
+public:
+    /**
+     * @brief Constructs a FramePacer targeting 60 frames per second.
+     */
+    FramePacer();
+
+    /**
+     * @brief Destroys the FramePacer.
+     */
+    ~FramePacer();
+
+    /**
+     * @brief Sets the frame rate of Target mode.
+     * @param fps Frames per second, values of 0 or less switch to Uncapped mode.
+     */
+    void SetTargetRate(double fps);
+
+    /**
+     * @brief Gets the frame rate of Target mode.
+     */
+    double GetTargetRate() const;
+
+    /**
+     * @brief Sets the pacing mode.
+     */
+    void SetMode(PacingMode mode);
+
+    /**
+     * @brief Gets the pacing mode.
+     */
+    PacingMode GetMode() const;
+
+    /**
+     * @brief Forgets the previous frame and the statistics.
+     *
+     * The next call to WaitForNextFrame returns 0, so time spent loading
+     * is not reported as a frame.
+     */
+    void Reset();
+
+    /**
+     * @brief Waits for the start of the next frame according to the mode.
+     * @return Seconds elapsed since the start of the previous frame.
+     */
+    double WaitForNextFrame();
+
+    /**
+     * @brief Gets the frame time statistics of the most recent frames.
+     */
+    FrameStats GetStats() const;
+
+    /**
+     * @brief Gets the most recent frame times, oldest first.
+     * @param result Output frame times in milliseconds, cleared before use.
+     */
+    void GetFrameTimes(std::vector<double>& result) const;
+};
+
+#endif // FRAMEPACER_HPP
@@ -1,22 +1,32 @@
 #include "Game.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 #include <glm/glm.hpp>
 
 #include "../Events/ClickEvent.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
 
 #include "../Systems/AnimationSystem.hpp"
 #include "../Systems/BoxCollisionSystem.hpp"
 #include "../Systems/AudioSystem.hpp"
 #include "../Systems/CameraMovementSystem.hpp"
 #include "../Systems/CircleCollisionSystem.hpp"
+#include "../Systems/ContinuousCollisionSystem.hpp"
 #include "../Systems/HitboxShowSystem.hpp"
 #include "../Systems/MovementSystem.hpp"
 #include "../Systems/OverlapSystem.hpp"
-#include "../Systems/PhysicsSystem.hpp"
 #include "../Systems/Render3DSystem.hpp"
 #include "../Systems/RenderSystem.hpp"
 #include "../Systems/RenderTextSystem.hpp"
 #include "../Systems/ScriptSystem.hpp"
+#include "../Systems/SleepSystem.hpp"
+#include "../Systems/TileCollisionSystem.hpp"
 #include "../Systems/UISystem.hpp"
 #include "../Systems/VideoSystem.hpp"
 
@@ -27,18 +37,26 @@ Game::Game() {
 	animationManager = std::make_unique<AnimationManager>();
 	assetManager = std::make_unique<AssetManager>();
 	controllerManager = std::make_unique<ControllerManager>();
+	inputRecorder = std::make_unique<InputRecorder>();
 	eventManager = std::make_unique<EventManager>();
+	framePacer = std::make_unique<FramePacer>();
+	performanceHud = std::make_unique<PerformanceHud>();
 	registry = std::make_unique<Registry>();
 	sceneManager = std::make_unique<SceneManager>();
+	tilemap = std::make_unique<Tilemap>();
 }
 
 Game::~Game() {
 	animationManager.reset();
 	assetManager.reset();
 	controllerManager.reset();
+	inputRecorder.reset();
 	eventManager.reset();
+	framePacer.reset();
+	performanceHud.reset();
 	registry.reset();
 	sceneManager.reset();
+	tilemap.reset();
 
 	std::cout << "Destructor completed for GAME" << std::endl;
 }
@@ -48,7 +66,39 @@ Game& Game::GetInstance() {
 	return game;
 }
 
+void Game::SetHeadless(int frames) {
+	isHeadless = true;
+	frameLimit = std::max(frames, 0);
+}
+
+void Game::SetScene(const std::string& path) {
+	sceneOverride = path;
+}
+
+void Game::SetStatsPath(const std::string& path) {
+	statsPath = path;
+	performanceHud->SetTiming(!path.empty());
+}
+
 void Game::init() {
+	if (isHeadless) {
+		if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+			std::cout << "[GAME] Error when starting SDL" << std::endl;
+			return;
+		}
+
+		this->windowWidth = 800;
+		this->windowHeight = 600;
+		this->mapWidth = 1000;
+		this->mapHeight = 600;
+		camera.w = windowWidth;
+		camera.h = windowHeight;
+
+		std::cout << "[GAME] Headless mode, running " << frameLimit << " frames" << std::endl;
+		this->isRunning = true;
+		return;
+	}
+
 	// Start SDL
 	if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
 		std::cout << "[GAME] Error when starting SDL" << std::endl;
@@ -110,142 +160,473 @@ void Game::setup() {
 	registry->AddSystem<AnimationSystem>();
 	registry->AddSystem<CameraMovementSystem>();
 	registry->AddSystem<CircleCollisionSystem>();
+	registry->AddSystem<ContinuousCollisionSystem>();
 	registry->AddSystem<HitboxShowSystem>();
 	registry->AddSystem<MovementSystem>();
 	registry->AddSystem<OverlapSystem>();
-	registry->AddSystem<PhysicsSystem>();
 	registry->AddSystem<Render3DSystem>();
 	registry->AddSystem<RenderSystem>();
 	registry->AddSystem<RenderTextSystem>();
 	registry->AddSystem<ScriptSystem>();
+	registry->AddSystem<SleepSystem>();
+	registry->AddSystem<TileCollisionSystem>();
 	registry->AddSystem<UISystem>();
 	registry->AddSystem<VideoSystem>();
 
+	// Subscriptions persist for the whole run
+	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
+
 	sceneManager->LoadSceneFromScript("./assets/scripts/scenes.lua", lua);
+	if (!sceneOverride.empty()) {
+		sceneManager->AddScene(sceneOverride, sceneOverride);
+		sceneManager->SetNextScene(sceneOverride);
+	}
+	loadSettings();
+	if (isHeadless) {
+		framePacer->SetMode(PacingMode::Uncapped);
+	}
 
 	lua.open_libraries(sol::lib::base, sol::lib::math);
 	registry->GetSystem<ScriptSystem>().CreateLuaBinding(lua);
 }
 
+void Game::loadSettings() {
+	sol::optional<sol::table> hasSettings = lua["settings"];
+	if (hasSettings == sol::nullopt) {
+		return;
+	}
+	sol::table settings = lua["settings"];
+
+	int rate = settings["tick_rate"].get_or(tickRate);
+	if (rate > 0) {
+		tickRate = rate;
+	}
+	else {
+		std::cout << "[GAME] Invalid tick_rate, using " << tickRate << std::endl;
+	}
+
+	int steps = settings["max_catch_up_steps"].get_or(maxCatchUpSteps);
+	if (steps > 0) {
+		maxCatchUpSteps = steps;
+	}
+	else {
+		std::cout << "[GAME] Invalid max_catch_up_steps, using " << maxCatchUpSteps << std::endl;
+	}
+
+	if (isHeadless) {
+		return;
+	}
+
+	sol::optional<std::string> hudFont = settings["hud_font"];
+	if (hudFont != sol::nullopt) {
+		performanceHud->LoadFont(renderer, hudFont.value(), settings["hud_font_size"].get_or(14));
+	}
+
+	// 0 or less runs uncapped
+	framePacer->SetTargetRate(settings["target_fps"].get_or(framePacer->GetTargetRate()));
+	if (settings["vsync"].get_or(false)) {
+		SetVsync(true);
+	}
+}
+
+void Game::SetVsync(bool enabled) {
+	if (isHeadless) {
+		return;
+	}
+
+	if (SDL_RenderSetVSync(renderer, enabled ? 1 : 0) != 0) {
+		std::cout << "[GAME] Vsync not supported by the renderer: " << SDL_GetError() << std::endl;
+		enabled = false;
+	}
+
+	if (enabled) {
+		framePacer->SetMode(PacingMode::Vsync);
+	}
+	else if (framePacer->GetMode() == PacingMode::Vsync) {
+		framePacer->SetMode(PacingMode::Target);
+	}
+}
+
 void Game::processInput() {
+	PROFILE_SCOPE("Game::processInput");
 	SDL_Event sdlEvent;
 
-	while (SDL_PollEvent(&sdlEvent)) {
-		switch (sdlEvent.type) {
-		case SDL_QUIT:
-			sceneManager->StopScene();
-			this->isRunning = false;
-			break;
-		case SDL_KEYDOWN:
-			if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
+	if (inputRecorder->IsReplaying()) {
+		while (SDL_PollEvent(&sdlEvent)) {
+			if (sdlEvent.type == SDL_RENDER_TARGETS_RESET || sdlEvent.type == SDL_RENDER_DEVICE_RESET) {
+				tilemap->InvalidateChunks();
+			}
+			if (sdlEvent.type == SDL_QUIT
+				|| (sdlEvent.type == SDL_KEYDOWN && sdlEvent.key.keysym.sym == SDLK_ESCAPE)) {
 				sceneManager->StopScene();
 				this->isRunning = false;
-				break;
-			}
-			else if (sdlEvent.key.keysym.sym == SDLK_p) {
-				this->isPaused = !this->isPaused;
-				break;
 			}
-			else if (sdlEvent.key.keysym.sym == SDLK_i) {
-				isDebugMode = !isDebugMode;
-				std::cout << "[GAME] Debug Mode changed to: " << isDebugMode << std::endl;
-				break;
-			}
-			controllerManager->KeyDown(sdlEvent.key.keysym.sym);
-			break;
-		case SDL_KEYUP:
-			controllerManager->KeyUp(sdlEvent.key.keysym.sym);
-			break;
-		case SDL_MOUSEMOTION:
-			int x, y;
-			SDL_GetMouseState(&x, &y);
-			controllerManager->SetMousePosition(x, y);
-			break;
-		case SDL_MOUSEBUTTONDOWN:
-			controllerManager->SetMousePosition(sdlEvent.button.x,
-				sdlEvent.button.y);
-			controllerManager->MouseButtonDown(
-				static_cast<int>(sdlEvent.button.button));
-			eventManager->EmitEvent<ClickEvent>(
-				static_cast<int>(sdlEvent.button.button),
-				sdlEvent.button.x,
-				sdlEvent.button.y);
-			break;
-		case SDL_MOUSEBUTTONUP:
-			controllerManager->SetMousePosition(sdlEvent.button.x,
-				sdlEvent.button.y);
-			controllerManager->MouseButtonUp(
-				static_cast<int>(sdlEvent.button.button));
+		}
+
+		if (!inputRecorder->ReadFrame(replayEvents, replaySteps)) {
+			std::cout << "[GAME] Replay finished" << std::endl;
+			sceneManager->StopScene();
+			this->isRunning = false;
+			return;
+		}
+		for (const auto& event : replayEvents) {
+			handleInput(event);
+		}
+		return;
+	}
+
+	while (SDL_PollEvent(&sdlEvent)) {
+		// Render target contents are lost with the device, chunks are baked again
+		if (sdlEvent.type == SDL_RENDER_TARGETS_RESET || sdlEvent.type == SDL_RENDER_DEVICE_RESET) {
+			tilemap->InvalidateChunks();
+		}
+		InputEvent event;
+		if (!InputRecorder::FromSdlEvent(sdlEvent, event)) {
+			continue;
+		}
+		inputRecorder->RecordEvent(event);
+		handleInput(event);
+	}
+}
+
+void Game::handleInput(const InputEvent& event) {
+	switch (event.type) {
+	case InputEventType::Quit:
+		sceneManager->StopScene();
+		this->isRunning = false;
+		break;
+	case InputEventType::KeyDown:
+		if (event.code == SDLK_ESCAPE) {
+			sceneManager->StopScene();
+			this->isRunning = false;
 			break;
-		case SDL_WINDOWEVENT:
+		}
+		else if (event.code == SDLK_p) {
+			this->isPaused = !this->isPaused;
 			break;
-		default:
+		}
+		else if (event.code == SDLK_i) {
+			isDebugMode = !isDebugMode;
+			performanceHud->SetEnabled(isDebugMode && !isHeadless);
+			std::cout << "[GAME] Debug Mode changed to: " << isDebugMode << std::endl;
 			break;
 		}
+		controllerManager->KeyDown(event.code);
+		break;
+	case InputEventType::KeyUp:
+		controllerManager->KeyUp(event.code);
+		break;
+	case InputEventType::MouseMotion:
+		controllerManager->SetMousePosition(event.x, event.y);
+		break;
+	case InputEventType::MouseButtonDown:
+		controllerManager->SetMousePosition(event.x, event.y);
+		controllerManager->MouseButtonDown(event.code);
+		eventManager->EmitEvent<ClickEvent>(event.code, event.x, event.y);
+		break;
+	case InputEventType::MouseButtonUp:
+		controllerManager->SetMousePosition(event.x, event.y);
+		controllerManager->MouseButtonUp(event.code);
+		break;
+	default:
+		break;
 	}
 }
 
 
 void Game::update() {
-	int timeToWait = MSPerFrame - (SDL_GetTicks() - msPreviousFrame);
-
-	if (0 < timeToWait && timeToWait <= MSPerFrame) {
-		SDL_Delay(timeToWait);
+	double deltaTime;
+	{
+		PROFILE_SCOPE("FramePacer::WaitForNextFrame");
+		deltaTime = framePacer->WaitForNextFrame();
+	}
+	if (!statsPath.empty() && deltaTime > 0.0) {
+		statsFrameTimes.push_back(deltaTime * 1000.0);
+	}
+	PROFILE_SCOPE("Game::update");
+	double step = 1.0 / tickRate;
+	if (inputRecorder->IsReplaying()) {
+		// Same steps as the recorded frame, whatever the machine
+		deltaTime = replaySteps * step;
+	}
+	else if (isHeadless) {
+		// One step per frame, so runs are repeatable whatever the machine
+		deltaTime = step;
 	}
 
-	double deltaTime = (SDL_GetTicks() - msPreviousFrame) / 1000.0;
-
-	msPreviousFrame = SDL_GetTicks();
-
+	frameSteps = 0;
 	if (isPaused) return;
 
-	eventManager->Reset();
-	registry->GetSystem<OverlapSystem>().SubscribeToCollisionEvent(eventManager);
-	registry->GetSystem<UISystem>().SubscribeToClickEvent(eventManager);
-
-	registry->Update();
+	// Simulation runs in fixed steps, whatever the frame rate
+	if (inputRecorder->IsReplaying()) {
+		for (; frameSteps < replaySteps; frameSteps++) {
+			fixedUpdate(step);
+		}
+		accumulator = 0.0;
+	}
+	else {
+		accumulator += deltaTime;
+		while (accumulator >= step && frameSteps < maxCatchUpSteps) {
+			fixedUpdate(step);
+			accumulator -= step;
+			frameSteps++;
+		}
+		if (accumulator >= step) {
+			// Too far behind, drop the time instead of spiraling
+			accumulator = 0.0;
+		}
+	}
+	renderAlpha = static_cast<float>(accumulator / step);
 
-	registry->GetSystem<PhysicsSystem>().Update();
-	registry->GetSystem<MovementSystem>().Update(deltaTime);
-	registry->GetSystem<CircleCollisionSystem>().Update(lua);
-	registry->GetSystem<BoxCollisionSystem>().Update(eventManager, lua);
-	registry->GetSystem<ScriptSystem>().Update(lua);
-	registry->GetSystem<AnimationSystem>().Update();
-	registry->GetSystem<CameraMovementSystem>().Update(camera);
+	auto& animation = registry->GetSystem<AnimationSystem>();
+	{
+		HudTimer timer(*performanceHud, "Animation", &animation);
+		animation.Update();
+	}
+	auto& cameraMovement = registry->GetSystem<CameraMovementSystem>();
+	{
+		HudTimer timer(*performanceHud, "CameraMovement", &cameraMovement);
+		cameraMovement.Update(camera, renderAlpha);
+	}
 	registry->GetSystem<VideoSystem>().setDeltaTime(deltaTime);
 }
 
+void Game::fixedUpdate(double dt) {
+	PROFILE_SCOPE("Game::fixedUpdate");
+	PerformanceHud& hud = *performanceHud;
+	{
+		PROFILE_SCOPE("Registry::Update");
+		HudTimer timer(hud, "Registry");
+		registry->Update();
+	}
+
+	auto& movement = registry->GetSystem<MovementSystem>();
+	auto& continuousCollision = registry->GetSystem<ContinuousCollisionSystem>();
+	auto& tileCollision = registry->GetSystem<TileCollisionSystem>();
+	auto& circleCollision = registry->GetSystem<CircleCollisionSystem>();
+	auto& boxCollision = registry->GetSystem<BoxCollisionSystem>();
+	auto& overlap = registry->GetSystem<OverlapSystem>();
+	auto& sleep = registry->GetSystem<SleepSystem>();
+	auto& script = registry->GetSystem<ScriptSystem>();
+	{
+		HudTimer timer(hud, "Movement", &movement);
+		movement.Update(dt);
+	}
+	{
+		HudTimer timer(hud, "ContinuousCollision", &continuousCollision);
+		continuousCollision.Update(tileCollision.GetGrid());
+	}
+	{
+		HudTimer timer(hud, "TileCollision", &tileCollision);
+		tileCollision.Update();
+	}
+	{
+		HudTimer timer(hud, "CircleCollision", &circleCollision);
+		circleCollision.Update(lua);
+	}
+	{
+		HudTimer timer(hud, "BoxCollision", &boxCollision);
+		boxCollision.Detect();
+	}
+	{
+		HudTimer timer(hud, "Overlap", &overlap);
+		overlap.Update(boxCollision);
+	}
+	{
+		// Contact callbacks are counted with the detection
+		HudTimer timer(hud, "BoxCollision", &boxCollision);
+		boxCollision.DispatchContacts(eventManager, lua);
+		eventManager->DispatchQueued();
+	}
+	{
+		HudTimer timer(hud, "Sleep", &sleep);
+		sleep.Update(boxCollision, dt);
+	}
+	{
+		HudTimer timer(hud, "Script", &script);
+		script.Update(lua);
+	}
+}
+
 void Game::render() {
 	if (isPaused) return;
+	PROFILE_SCOPE("Game::render");
 	SDL_SetRenderDrawColor(this->renderer, 30, 30, 30, 255);
 	SDL_RenderClear(this->renderer);
 
-	registry->GetSystem<VideoSystem>().Update(renderer, camera, assetManager);
-	registry->GetSystem<RenderSystem>().Update(renderer, camera, assetManager);
-	registry->GetSystem<RenderTextSystem>().Update(renderer, assetManager);
-	registry->GetSystem<Render3DSystem>().Update(renderer, assetManager);
+	RenderStats::Reset();
+	PerformanceHud& hud = *performanceHud;
+	auto& video = registry->GetSystem<VideoSystem>();
+	auto& renderSprite = registry->GetSystem<RenderSystem>();
+	auto& renderText = registry->GetSystem<RenderTextSystem>();
+	auto& render3D = registry->GetSystem<Render3DSystem>();
+	{
+		HudTimer timer(hud, "Video", &video);
+		video.Update(renderer, camera, assetManager);
+	}
+	{
+		HudTimer timer(hud, "Render", &renderSprite);
+		renderSprite.Update(renderer, camera, assetManager, *tilemap, renderAlpha);
+	}
+	{
+		HudTimer timer(hud, "RenderText", &renderText);
+		renderText.Update(renderer, assetManager);
+	}
+	{
+		HudTimer timer(hud, "Render3D", &render3D);
+		render3D.Update(renderer, assetManager);
+	}
 
 	if (isDebugMode) {
 		registry->GetSystem<HitboxShowSystem>().Update(renderer, camera);
-		registry->GetSystem<Render3DSystem>().UpdateWireframe(renderer, assetManager);
+		registry->GetSystem<TileCollisionSystem>().RenderDebug(renderer, camera);
+		render3D.UpdateWireframe(renderer, assetManager);
+
+		// Last, so it covers the scene and counts everything drawn before it
+		hud.Render(renderer, *framePacer);
 	}
 
-	SDL_RenderPresent(this->renderer);
+	{
+		PROFILE_SCOPE("SDL_RenderPresent");
+		SDL_RenderPresent(this->renderer);
+	}
 }
 
 void Game::RunScene() {
+	// The next scene changes as soon as a script asks for another one
+	std::string sceneName = sceneManager->GetNextScene();
+	Uint64 loadStart = SDL_GetPerformanceCounter();
 	sceneManager->LoadScene();
 	registry->GetSystem<AudioSystem>().playSceneMusic(assetManager);
+	loadMs = static_cast<double>(SDL_GetPerformanceCounter() - loadStart) * 1000.0
+		/ SDL_GetPerformanceFrequency();
+
+	// Loading time is not simulated
+	framePacer->Reset();
+	accumulator = 0.0;
+	performanceHud->ResetTotals();
+	statsFrameTimes.clear();
 
 	while (sceneManager->IsSceneRunning()) {
 		processInput();
 		update();
-		render();
+		inputRecorder->EndFrame(frameSteps);
+		if (!isHeadless) {
+			render();
+		}
+		performanceHud->EndFrame();
+
+		frameCount++;
+		if (frameLimit > 0 && frameCount >= frameLimit) {
+			sceneManager->StopScene();
+			isRunning = false;
+		}
+	}
+	FrameStats stats = framePacer->GetStats();
+	std::cout << "[GAME] " << stats.frameCount << " frames, frame time avg "
+		<< stats.averageMs << " ms, stddev " << stats.stddevMs << " ms, min "
+		<< stats.minMs << " ms, max " << stats.maxMs << " ms" << std::endl;
+	if (!statsPath.empty()) {
+		writeStats(sceneName);
 	}
+
 	assetManager->ClearAssets();
+	tilemap->Clear();
+	eventManager->ClearQueued();
 	registry->ClearAllEntities();
+	registry->GetSystem<TileCollisionSystem>().GetGrid().Clear();
+	registry->GetSystem<SleepSystem>().Clear();
+	registry->GetSystem<BoxCollisionSystem>().ClearPairCache();
+	registry->GetSystem<RenderSystem>().ClearMarks();
+}
+
+
+// Writes a name as a JSON string
+static void WriteJsonString(std::FILE* file, const std::string& text) {
+	std::fputc('"', file);
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			std::fputc('\\', file);
+			std::fputc(c, file);
+		}
+		else if (static_cast<unsigned char>(c) < 0x20) {
+			std::fprintf(file, "\\u%04x", static_cast<unsigned char>(c));
+		}
+		else {
+			std::fputc(c, file);
+		}
+	}
+	std::fputc('"', file);
 }
 
+void Game::writeStats(const std::string& sceneName) {
+	std::FILE* file = std::fopen(statsPath.c_str(), "w");
+	if (file == nullptr) {
+		std::cerr << "[GAME] Could not write the statistics to " << statsPath << std::endl;
+		return;
+	}
+
+	// Nearest rank percentiles over every frame of the scene, not only the pacer window
+	std::vector<double> sorted = statsFrameTimes;
+	std::sort(sorted.begin(), sorted.end());
+	int count = static_cast<int>(sorted.size());
+	double sum = 0.0;
+	for (double ms : sorted) {
+		sum += ms;
+	}
+	auto percentile = [&](double p) {
+		if (count == 0) {
+			return 0.0;
+		}
+		int rank = static_cast<int>(std::ceil(p * count)) - 1;
+		return sorted[std::min(std::max(rank, 0), count - 1)];
+	};
+
+	// High water mark of the resident set, in kilobytes on Linux and bytes on macOS
+	long peakMemoryKb = -1;
+#if defined(__linux__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		peakMemoryKb = usage.ru_maxrss;
+	}
+#elif defined(__APPLE__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0) {
+		peakMemoryKb = usage.ru_maxrss / 1024;
+	}
+#endif
+
+	std::fprintf(file, "{\n");
+	std::fprintf(file, "  \"scene\": ");
+	WriteJsonString(file, sceneName);
+	std::fprintf(file, ",\n");
+	std::fprintf(file, "  \"frames\": %d,\n", count);
+	std::fprintf(file, "  \"load_ms\": %.3f,\n", loadMs);
+	std::fprintf(file, "  \"frame_ms\": { \"avg\": %.4f, \"p50\": %.4f, \"p95\": %.4f, "
+		"\"p99\": %.4f, \"max\": %.4f },\n", count > 0 ? sum / count : 0.0,
+		percentile(0.50), percentile(0.95), percentile(0.99), count > 0 ? sorted.back() : 0.0);
+	if (peakMemoryKb >= 0) {
+		std::fprintf(file, "  \"peak_memory_kb\": %ld,\n", peakMemoryKb);
+	}
+	else {
+		std::fprintf(file, "  \"peak_memory_kb\": null,\n");
+	}
+
+	std::vector<TimerSummary> summaries;
+	performanceHud->GetSummary(summaries);
+	std::fprintf(file, "  \"systems\": [\n");
+	for (size_t i = 0; i < summaries.size(); i++) {
+		const TimerSummary& summary = summaries[i];
+		std::fprintf(file, "    { \"name\": ");
+		WriteJsonString(file, summary.name);
+		std::fprintf(file, ", \"mean_ms\": %.4f, \"entities\": %d }%s\n",
+			summary.meanMs, summary.entities, i + 1 < summaries.size() ? "," : "");
+	}
+	std::fprintf(file, "  ]\n");
+	std::fprintf(file, "}\n");
+	std::fclose(file);
+	std::cout << "[GAME] Statistics written to " << statsPath << std::endl;
+}
 
 void Game::run() {
 	setup();
@@ -257,6 +638,18 @@ void Game::run() {
 
 void Game::destroy() {
 	// Clean Up
+	inputRecorder->Stop();
+	if (registry->HasSystem<UISystem>()) {
+		registry->GetSystem<UISystem>().UnsubscribeFromClickEvent(eventManager);
+	}
+
+	if (isHeadless) {
+		SDL_Quit();
+		return;
+	}
+
+	performanceHud->Clear();
+	tilemap->Clear();
 	SDL_DestroyRenderer(this->renderer);
 	SDL_DestroyWindow(this->window);
 
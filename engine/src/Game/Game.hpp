@@ -12,26 +12,22 @@
 #define GAME_HPP
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <sol/sol.hpp>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include "../AnimationManager/AnimationManager.hpp"
 #include "../AssetManager/AssetManager.hpp"
+#include "../AssetManager/Tilemap.hpp"
 #include "../ControllerManager/ControllerManager.hpp"
+#include "../ControllerManager/InputRecorder.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../ECS/ECS.hpp"
 #include "../SceneManager/SceneManager.hpp"
-
-/**
- * @brief Target frames per second for the game
- */
-const int FPS = 60;
-
-/**
- * @brief Milliseconds per frame based on target FPS
- */
-const int MSPerFrame = 1000 / FPS;
+#include "FramePacer.hpp"
+#include "PerformanceHud.hpp"
 
 /**
  * @class Game
@@ -48,9 +44,6 @@ private:
     /** @brief Camera rectangle defining the viewport */
     SDL_Rect camera = { 0,0,0,0 };
 
-    /** @brief Time tracking for frame rate control */
-    int msPreviousFrame = 0;
-
     /** @brief Flag indicating if the game is currently running */
     bool isRunning = false;
 
@@ -60,6 +53,48 @@ private:
     /** @brief Flag indicating if the game is being debugged */
     bool isDebugMode = false;
 
+    /** @brief Flag indicating if the game runs without window, renderer and audio */
+    bool isHeadless = false;
+
+    /** @brief Frames to run before quitting, 0 runs until the game is closed */
+    int frameLimit = 0;
+
+    /** @brief Frames run since the game started */
+    int frameCount = 0;
+
+    /** @brief Simulation steps per second */
+    int tickRate = 60;
+
+    /** @brief Most simulation steps run in one frame, time beyond that is dropped */
+    int maxCatchUpSteps = 5;
+
+    /** @brief Frame time not yet consumed by simulation steps, in seconds */
+    double accumulator = 0.0;
+
+    /** @brief Position of the frame between the last two simulation steps, from 0 to 1 */
+    float renderAlpha = 1.0f;
+
+    /** @brief Simulation steps run by the current frame */
+    int frameSteps = 0;
+
+    /** @brief Simulation steps of the frame being replayed */
+    int replaySteps = 0;
+
+    /** @brief Input of the frame being replayed */
+    std::vector<InputEvent> replayEvents;
+
+    /** @brief Scene file run instead of the first scene of the scenes script, empty for none */
+    std::string sceneOverride;
+
+    /** @brief File receiving the statistics of each scene as JSON, empty for none */
+    std::string statsPath;
+
+    /** @brief Time spent loading the current scene, in milliseconds */
+    double loadMs = 0.0;
+
+    /** @brief Every frame time of the current scene in milliseconds, kept only with statsPath */
+    std::vector<double> statsFrameTimes;
+
 public:
     /** @brief SDL renderer pointer used for drawing */
     SDL_Renderer* renderer = nullptr;
@@ -73,15 +108,27 @@ public:
     /** @brief Manager for handling input controllers */
     std::unique_ptr<ControllerManager> controllerManager;
 
+    /** @brief Input recording and replay */
+    std::unique_ptr<InputRecorder> inputRecorder;
+
     /** @brief Manager for handling game events */
     std::unique_ptr<EventManager> eventManager;
 
+    /** @brief Frame rate limiter and frame time statistics */
+    std::unique_ptr<FramePacer> framePacer;
+
+    /** @brief Debug overlay with frame and system timings */
+    std::unique_ptr<PerformanceHud> performanceHud;
+
     /** @brief Registry for the Entity Component System */
     std::unique_ptr<Registry> registry;
 
     /** @brief Manager for handling different game scenes */
     std::unique_ptr<SceneManager> sceneManager;
 
+    /** @brief Tile layers of the current map, drawn as baked chunks */
+    std::unique_ptr<Tilemap> tilemap;
+
     /** @brief Lua state for scripting support */
     sol::state lua;
 
@@ -100,14 +147,36 @@ public:
 private:
     /**
      * @brief Process user input and events
+     *
+     * Live input is recorded when recording; during a replay the recorded
+     * frame is used instead and live input can only quit.
      */
     void processInput();
 
+    /**
+     * @brief Apply one input event to the game and the input managers
+     */
+    void handleInput(const InputEvent& event);
+
     /**
      * @brief Update game state
+     *
+     * Runs as many fixed simulation steps as the elapsed time allows, then
+     * the per frame systems.
      */
     void update();
 
+    /**
+     * @brief Advance the simulation by one fixed step
+     * @param dt Length of the step in seconds
+     */
+    void fixedUpdate(double dt);
+
+    /**
+     * @brief Read the optional settings table of the scenes script
+     */
+    void loadSettings();
+
     /**
      * @brief Render the current frame
      */
@@ -123,6 +192,12 @@ private:
      */
     void RunScene();
 
+    /**
+     * @brief Write the load time, frame times, peak memory and system times of the scene to statsPath
+     * @param sceneName Name of the scene that just ended
+     */
+    void writeStats(const std::string& sceneName);
+
     /**
      * @brief Private constructor for singleton pattern
      */
@@ -140,10 +215,37 @@ public:
      */
     static Game& GetInstance();
 
+    /**
+     * @brief Run without window, renderer and audio
+     * @param frames Frames to run before quitting, 0 runs until the game is closed
+     *
+     * Must be called before init. Scenes are simulated with one fixed step
+     * per frame as fast as possible and never rendered.
+     */
+    void SetHeadless(int frames);
+
+    /**
+     * @brief Run a scene file instead of the first scene of the scenes script
+     * @param path Lua file describing the scene, in the assets/scripts/Scenes format
+     *
+     * Must be called before run. The scenes script is still read for its settings.
+     */
+    void SetScene(const std::string& path);
+
+    /**
+     * @brief Write the statistics of every scene to a JSON file when it ends
+     * @param path Destination file, overwritten by each scene
+     *
+     * Must be called before run. Turns on the system timers of the
+     * PerformanceHud without drawing it.
+     */
+    void SetStatsPath(const std::string& path);
+
     /**
      * @brief Initialize the game engine
      *
-     * Sets up SDL, creates window and renderer, initializes all managers
+     * Sets up SDL, creates window and renderer, initializes all managers.
+     * In headless mode only the SDL timer and events are started.
      */
     void init();
 
@@ -154,6 +256,14 @@ public:
      */
     void run();
 
+    /**
+     * @brief Turn vertical sync on or off
+     * @param enabled True to wait for the display refresh on present
+     *
+     * Falls back to the target frame rate if the renderer cannot change vsync.
+     */
+    void SetVsync(bool enabled);
+
     /**
      * @brief Clean up and shut down the game
      *
@@ -0,0 +1,234 @@
+#include "PerformanceHud.hpp"
+
+#include <SDL2/SDL_ttf.h>
+#include <SDL2_gfx/SDL2_gfxPrimitives.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "../Utils/RenderStats.hpp"
+
+PerformanceHud::PerformanceHud() {
+	frequency = SDL_GetPerformanceFrequency();
+}
+
+PerformanceHud::~PerformanceHud() {
+	Clear();
+}
+
+bool PerformanceHud::LoadFont(SDL_Renderer* renderer, const std::string& path, int size) {
+	Clear();
+	TTF_Font* font = TTF_OpenFont(path.c_str(), size);
+	if (font == nullptr) {
+		std::cerr << "[PERFORMANCEHUD] " << TTF_GetError() << std::endl;
+		return false;
+	}
+
+	// Rasterize every glyph once; the font is not needed afterwards
+	SDL_Color white = { 255, 255, 255, 255 };
+	glyphs.resize(LAST_GLYPH - FIRST_GLYPH + 1);
+	for (int c = FIRST_GLYPH; c <= LAST_GLYPH; c++) {
+		Glyph& glyph = glyphs[c - FIRST_GLYPH];
+		int minX, maxX, minY, maxY;
+		if (TTF_GlyphMetrics(font, static_cast<Uint16>(c), &minX, &maxX, &minY, &maxY, &glyph.advance) != 0) {
+			continue;
+		}
+
+		SDL_Surface* surface = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(c), white);
+		if (surface == nullptr) {
+			continue;
+		}
+		glyph.texture = SDL_CreateTextureFromSurface(renderer, surface);
+		glyph.width = surface->w;
+		glyph.height = surface->h;
+		SDL_FreeSurface(surface);
+		RenderStats::CountUpload();
+	}
+	lineHeight = TTF_FontLineSkip(font);
+	TTF_CloseFont(font);
+
+	std::cout << "[PERFORMANCEHUD] Cached " << glyphs.size() << " glyphs from " << path << std::endl;
+	return true;
+}
+
+void PerformanceHud::Clear() {
+	for (auto& glyph : glyphs) {
+		if (glyph.texture != nullptr) {
+			SDL_DestroyTexture(glyph.texture);
+		}
+	}
+	glyphs.clear();
+	lineHeight = 0;
+	// Resetting the SDL2_gfx font destroys the character textures it cached
+	gfxPrimitivesSetFont(NULL, 0, 0);
+}
+
+void PerformanceHud::SetEnabled(bool enabled) {
+	isEnabled = enabled;
+}
+
+bool PerformanceHud::IsEnabled() const {
+	return isEnabled;
+}
+
+void PerformanceHud::SetTiming(bool timing) {
+	isTiming = timing;
+}
+
+bool PerformanceHud::IsTiming() const {
+	return isEnabled || isTiming;
+}
+
+void PerformanceHud::ResetTotals() {
+	for (auto& timer : timers) {
+		timer.frameMs = 0.0;
+		timer.totalMs = 0.0;
+	}
+	timedFrames = 0;
+}
+
+void PerformanceHud::GetSummary(std::vector<TimerSummary>& result) const {
+	result.clear();
+	for (const auto& timer : timers) {
+		TimerSummary summary;
+		summary.name = timer.name;
+		summary.meanMs = timedFrames > 0 ? timer.totalMs / timedFrames : 0.0;
+		summary.entities = timer.system != nullptr ? timer.system->GetEntityCount() : -1;
+		result.push_back(summary);
+	}
+}
+
+int PerformanceHud::GetTimer(const char* name, const System* system) {
+	for (size_t i = 0; i < timers.size(); i++) {
+		if (timers[i].name == name || std::strcmp(timers[i].name, name) == 0) {
+			return static_cast<int>(i);
+		}
+	}
+
+	Timer timer;
+	timer.name = name;
+	timer.system = system;
+	timers.push_back(timer);
+	return static_cast<int>(timers.size()) - 1;
+}
+
+void PerformanceHud::AddTime(int timer, double ms) {
+	timers[timer].frameMs += ms;
+}
+
+void PerformanceHud::EndFrame() {
+	if (!IsTiming()) {
+		return;
+	}
+	for (auto& timer : timers) {
+		timer.averageMs += (timer.frameMs - timer.averageMs) * SMOOTHING;
+		timer.totalMs += timer.frameMs;
+		timer.frameMs = 0.0;
+	}
+	timedFrames++;
+}
+
+Uint64 PerformanceHud::GetFrequency() const {
+	return frequency;
+}
+
+int PerformanceHud::DrawText(SDL_Renderer* renderer, int x, int y, const char* text) {
+	if (glyphs.empty()) {
+		stringRGBA(renderer, static_cast<Sint16>(x), static_cast<Sint16>(y), text, 255, 255, 255, 255);
+		return static_cast<int>(std::strlen(text)) * 8;
+	}
+
+	int start = x;
+	for (const char* c = text; *c != '\0'; c++) {
+		int index = static_cast<unsigned char>(*c) - FIRST_GLYPH;
+		if (index < 0 || index >= static_cast<int>(glyphs.size())) {
+			continue;
+		}
+		const Glyph& glyph = glyphs[index];
+		if (glyph.texture != nullptr) {
+			SDL_Rect dstRect = { x, y, glyph.width, glyph.height };
+			SDL_RenderCopy(renderer, glyph.texture, NULL, &dstRect);
+		}
+		x += glyph.advance;
+	}
+	return x - start;
+}
+
+void PerformanceHud::Render(SDL_Renderer* renderer, const FramePacer& framePacer) {
+	if (!isEnabled) {
+		return;
+	}
+
+	// Read the counters before the overlay adds its own draws
+	int drawCalls = RenderStats::drawCalls;
+	int textureUploads = RenderStats::textureUploads;
+	FrameStats stats = framePacer.GetStats();
+	framePacer.GetFrameTimes(frameTimes);
+
+	const int margin = 8;
+	const int padding = 6;
+	int textHeight = lineHeight > 0 ? lineHeight : BUILTIN_LINE_HEIGHT;
+	int textLines = 3 + static_cast<int>(timers.size());
+	int graphWidth = static_cast<int>(std::max<size_t>(frameTimes.size(), 120));
+	SDL_Rect panel = {
+		margin, margin,
+		std::max(graphWidth, 300) + padding * 2,
+		textLines * textHeight + GRAPH_HEIGHT + padding * 3
+	};
+
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+	SDL_RenderFillRect(renderer, &panel);
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+	int x = panel.x + padding;
+	int y = panel.y + padding;
+	char line[96];
+	double lastMs = frameTimes.empty() ? 0.0 : frameTimes.back();
+	std::snprintf(line, sizeof(line), "frame %.2f ms  avg %.2f ms", lastMs, stats.averageMs);
+	DrawText(renderer, x, y, line);
+	y += textHeight;
+
+	std::snprintf(line, sizeof(line), "p50 %.2f  p95 %.2f  p99 %.2f ms",
+		stats.p50Ms, stats.p95Ms, stats.p99Ms);
+	DrawText(renderer, x, y, line);
+	y += textHeight;
+
+	std::snprintf(line, sizeof(line), "draws %d  uploads %d", drawCalls, textureUploads);
+	DrawText(renderer, x, y, line);
+	y += textHeight;
+
+	for (const auto& timer : timers) {
+		if (timer.system != nullptr) {
+			std::snprintf(line, sizeof(line), "%-20s %6.3f ms %6d",
+				timer.name, timer.averageMs, timer.system->GetEntityCount());
+		}
+		else {
+			std::snprintf(line, sizeof(line), "%-20s %6.3f ms", timer.name, timer.averageMs);
+		}
+		DrawText(renderer, x, y, line);
+		y += textHeight;
+	}
+	y += padding;
+
+	// Graph scaled so the target frame time sits at half height
+	double targetMs = framePacer.GetMode() == PacingMode::Target
+		? 1000.0 / framePacer.GetTargetRate() : std::max(stats.averageMs, 1.0);
+	double scale = GRAPH_HEIGHT / (targetMs * 2.0);
+	int bottom = y + GRAPH_HEIGHT;
+
+	SDL_SetRenderDrawColor(renderer, 0, 160, 0, 255);
+	int targetY = bottom - static_cast<int>(targetMs * scale);
+	SDL_RenderDrawLine(renderer, x, targetY, x + graphWidth, targetY);
+
+	graphPoints.clear();
+	for (size_t i = 0; i < frameTimes.size(); i++) {
+		int height = std::min(static_cast<int>(frameTimes[i] * scale), GRAPH_HEIGHT);
+		graphPoints.push_back({ x + static_cast<int>(i), bottom - height });
+	}
+	if (graphPoints.size() > 1) {
+		SDL_SetRenderDrawColor(renderer, 255, 220, 0, 255);
+		SDL_RenderDrawLines(renderer, graphPoints.data(), static_cast<int>(graphPoints.size()));
+	}
+}
@@ -0,0 +1,226 @@
+/**
+ * @file PerformanceHud.hpp
+ * @brief Debug overlay with frame time percentiles and per system timings
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup MainFlow
+ */
+
+#ifndef PERFORMANCEHUD_HPP
+#define PERFORMANCEHUD_HPP
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+#include "../ECS/ECS.hpp"
+#include "FramePacer.hpp"
+
+/**
+ * @brief Mean time of one system over the frames timed since ResetTotals
+ */
+struct TimerSummary {
+    std::string name;    /**< Timer label */
+    double meanMs = 0.0; /**< Mean time per frame */
+    int entities = -1;   /**< Entities of the system, -1 without a system */
+};
+
+/**
+ * @class PerformanceHud
+ * @brief Draws frame statistics on top of the scene while debug mode is on.
+ *
+ * Shows the frame time and its p50/p95/p99 over the FramePacer window, the
+ * draw calls and texture uploads counted by RenderStats, the averaged time
+ * of every timed system with its entity count, and a graph of the recent
+ * frame times against the target.
+ *
+ * Text is drawn from one texture per printable ASCII glyph, rasterized once
+ * when the font is loaded, so the overlay never calls SDL_ttf per frame.
+ * Without a font (hud_font unset or unreadable) the text falls back to the
+ * 8x8 font built into SDL2_gfx.
+ */
+class PerformanceHud {
+private:
+    /** @brief First cached character */
+    static constexpr int FIRST_GLYPH = 32;
+
+    /** @brief Last cached character */
+    static constexpr int LAST_GLYPH = 126;
+
+    /** @brief Distance between text lines drawn with the SDL2_gfx font */
+    static constexpr int BUILTIN_LINE_HEIGHT = 10;
+
+    /** @brief Height of the frame time graph in pixels */
+    static constexpr int GRAPH_HEIGHT = 60;
+
+    /** @brief Weight of the newest frame in the averaged system times */
+    static constexpr double SMOOTHING = 0.1;
+
+    /**
+     * @brief Cached texture of one character.
+     */
+    struct Glyph {
+        SDL_Texture* texture = nullptr; /**< Null for blank characters */
+        int width = 0; /**< Texture width */
+        int height = 0; /**< Texture height */
+        int advance = 0; /**< Horizontal distance to the next character */
+    };
+
+    /**
+     * @brief Time spent by one system.
+     */
+    struct Timer {
+        const char* name = nullptr; /**< Label, must be a string literal */
+        const System* system = nullptr; /**< System whose entities are counted, may be null */
+        double frameMs = 0.0; /**< Time accumulated during the current frame */
+        double averageMs = 0.0; /**< Smoothed time per frame */
+        double totalMs = 0.0; /**< Time accumulated since the last ResetTotals */
+    };
+
+    bool isEnabled = false; ///< True while the overlay is drawn and timers run.
+    bool isTiming = false; ///< True while timers run without the overlay.
+    int timedFrames = 0; ///< Frames accumulated in the totals since the last ResetTotals.
+    std::vector<Glyph> glyphs; ///< Cached glyphs from FIRST_GLYPH to LAST_GLYPH.
+    int lineHeight = 0; ///< Distance between text lines, 0 without a font.
+    std::vector<Timer> timers; ///< Timers in the order they were first used.
+    std::vector<double> frameTimes; ///< Scratch buffer for the graph.
+    std::vector<SDL_Point> graphPoints; ///< Scratch buffer for the graph.
+    Uint64 frequency = 0; ///< Performance counter ticks per second.
+
+    /**
+     * @brief Draws one line of text with the cached glyphs.
+     * @return Width of the text in pixels.
+     */
+    int DrawText(SDL_Renderer* renderer, int x, int y, const char* text);
+
+public:
+    /**
+     * @brief Constructs a disabled PerformanceHud without a font.
+     */
+    PerformanceHud();
+
+    /**
+     * @brief Destroys the glyph textures.
+     */
+    ~PerformanceHud();
+
+    /**
+     * @brief Rasterizes the glyph textures from a TrueType font.
+     * @param renderer Renderer owning the textures.
+     * @param path Font file.
+     * @param size Point size.
+     * @return False if the font could not be opened; the overlay then uses the SDL2_gfx font.
+     */
+    bool LoadFont(SDL_Renderer* renderer, const std::string& path, int size);
+
+    /**
+     * @brief Destroys the glyph textures, must run before the renderer is destroyed.
+     *
+     * Also drops the glyphs SDL2_gfx cached for the fallback font.
+     */
+    void Clear();
+
+    /**
+     * @brief Turns the overlay and its timers on or off.
+     */
+    void SetEnabled(bool enabled);
+
+    /**
+     * @brief Checks whether the overlay is on.
+     */
+    bool IsEnabled() const;
+
+    /**
+     * @brief Runs the timers while the overlay is off, used for benchmark statistics.
+     */
+    void SetTiming(bool timing);
+
+    /**
+     * @brief Checks whether the timers run, either for the overlay or for statistics.
+     */
+    bool IsTiming() const;
+
+    /**
+     * @brief Forgets the totals accumulated by EndFrame.
+     */
+    void ResetTotals();
+
+    /**
+     * @brief Gets the mean time of every timer since the last ResetTotals.
+     * @param result Output summaries in the order the timers were first used, cleared before use.
+     */
+    void GetSummary(std::vector<TimerSummary>& result) const;
+
+    /**
+     * @brief Gets the timer with a label, creating it on first use.
+     * @param name Label, must be a string literal.
+     * @param system System whose entity count is shown next to the time, may be null.
+     * @return Index of the timer.
+     */
+    int GetTimer(const char* name, const System* system = nullptr);
+
+    /**
+     * @brief Adds time to a timer for the current frame.
+     */
+    void AddTime(int timer, double ms);
+
+    /**
+     * @brief Folds the times of the current frame into the averages and totals.
+     */
+    void EndFrame();
+
+    /**
+     * @brief Draws the overlay, call after every other render system.
+     */
+    void Render(SDL_Renderer* renderer, const FramePacer& framePacer);
+
+    /**
+     * @brief Gets the performance counter frequency used by HudTimer.
+     */
+    Uint64 GetFrequency() const;
+};
+
+/**
+ * @class HudTimer
+ * @brief Adds the lifetime of a scope to a PerformanceHud timer.
+ *
+ * Does nothing but a flag check while the timers are off.
+ */
+class HudTimer {
+private:
+    PerformanceHud& hud; ///< Overlay receiving the time.
+    const char* name; ///< Timer label.
+    const System* system; ///< System counted next to the time.
+    Uint64 start = 0; ///< Counter at construction, 0 while the timers are off.
+
+public:
+    /**
+     * @brief Starts timing a scope.
+     * @param hud Overlay receiving the time.
+     * @param name Timer label, must be a string literal.
+     * @param system System whose entity count is shown, may be null.
+     */
+    HudTimer(PerformanceHud& hud, const char* name, const System* system = nullptr)
+        : hud(hud), name(name), system(system) {
+        if (hud.IsTiming()) {
+            start = SDL_GetPerformanceCounter();
+        }
+    }
+
+    /**
+     * @brief Adds the elapsed time to the timer.
+     */
+    ~HudTimer() {
+        if (start == 0 || !hud.IsTiming()) {
+            return;
+        }
+        double ms = static_cast<double>(SDL_GetPerformanceCounter() - start) * 1000.0
+            / hud.GetFrequency();
+        hud.AddTime(hud.GetTimer(name, system), ms);
+    }
+
+    HudTimer(const HudTimer&) = delete;
+    HudTimer& operator=(const HudTimer&) = delete;
+};
+
+#endif // PERFORMANCEHUD_HPP
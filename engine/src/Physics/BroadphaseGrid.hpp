@@ -0,0 +1,358 @@
+/**
+ * @file BroadphaseGrid.hpp
+ * @brief Uniform grid broadphase that produces candidate collider pairs
+ * @author Juan Torres
+ * @date 2024
+ * @defgroup Physics Physics
+ * @{
+ * @brief Collision detection and physics helpers shared by the systems
+ */
+
+#ifndef BROADPHASEGRID_HPP
+#define BROADPHASEGRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Axis aligned bounds of a collider in world space.
+ */
+struct Aabb {
+    float minX; /**< Left edge */
+    float minY; /**< Top edge */
+    float maxX; /**< Right edge */
+    float maxY; /**< Bottom edge */
+};
+
+/**
+ * @brief Pair of proxy indices, always stored with a < b.
+ */
+struct ProxyPair {
+    int a; /**< Lower proxy index */
+    int b; /**< Higher proxy index */
+};
+
+/**
+ * @brief Uniform grid rebuilt every frame from the collider bounds.
+ *
+ * Each proxy is inserted in every cell its bounds touch. Two proxies become a
+ * candidate pair when they share a cell; the pair is only reported from the
+ * first cell both of them touch so it never appears twice. Proxies covering
+ * too many cells (map sized backgrounds) are kept apart and paired with
+ * everything instead of flooding the grid.
+ *
+ * Candidate pairs are returned sorted by (a, b). When proxies are gathered in
+ * entity id order this is the same order the old all-pairs loop used.
+ *
+ * Coordinates come from scripts, so they are clamped to MAX_CELL cells
+ * around the origin, NaN counting as 0, and queries only walk the cells
+ * that hold proxies.
+ */
+class BroadphaseGrid {
+private:
+    /** @brief One proxy registered in one cell */
+    struct CellEntry {
+        int64_t key; /**< Packed cell coordinates */
+        int cellX;   /**< Cell column */
+        int cellY;   /**< Cell row */
+        int proxy;   /**< Proxy index */
+    };
+
+    /** @brief Inclusive range of cells touched by a proxy */
+    struct CellRange {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    /** @brief Cell coordinates are clamped to [-MAX_CELL, MAX_CELL] */
+    static constexpr float MAX_CELL = static_cast<float>(1 << 20);
+
+    float cellSize; /**< Side of a cell in pixels */
+    int maxCellsPerProxy; /**< Proxies above this many cells are oversized */
+    std::vector<Aabb> bounds; /**< Bounds of every proxy */
+    std::vector<CellRange> ranges; /**< Cells touched by every proxy */
+    std::vector<CellEntry> entries; /**< Cell entries sorted by cell */
+    std::vector<int> oversized; /**< Proxies kept out of the grid */
+    CellRange extent = { 0, 0, -1, -1 }; /**< Cells holding at least one entry, empty when minX > maxX */
+
+    /**
+     * @brief Packs two cell coordinates into a sortable key.
+     */
+    static int64_t CellKey(int x, int y) {
+        // Flipping the sign bit keeps negative columns before positive ones in a
+        // row, and multiplying avoids shifting a negative row
+        return static_cast<int64_t>(y) * (int64_t(1) << 32)
+            + (static_cast<uint32_t>(x) ^ 0x80000000u);
+    }
+
+    /**
+     * @brief Converts a world coordinate to a cell coordinate.
+     */
+    int ToCell(float value) const {
+        float cell = std::floor(value / cellSize);
+        // The cast is undefined for NaN and for values past the int range
+        if (std::isnan(cell)) {
+            return 0;
+        }
+        return static_cast<int>(std::max(-MAX_CELL, std::min(MAX_CELL, cell)));
+    }
+
+    /**
+     * @brief Clips a segment to the cells holding entries.
+     * @param t0, t1 Output segment parameters of the part inside.
+     * @return False if the segment misses those cells or is not finite.
+     */
+    bool ClipToExtent(float x0, float y0, float dx, float dy, float& t0, float& t1) const {
+        if (extent.minX > extent.maxX || !std::isfinite(x0) || !std::isfinite(y0)
+            || !std::isfinite(dx) || !std::isfinite(dy)) {
+            return false;
+        }
+        const float from[2] = { x0, y0 };
+        const float delta[2] = { dx, dy };
+        const float mins[2] = { extent.minX * cellSize, extent.minY * cellSize };
+        const float maxs[2] = { (extent.maxX + 1) * cellSize, (extent.maxY + 1) * cellSize };
+        t0 = 0.0f;
+        t1 = 1.0f;
+        for (int axis = 0; axis < 2; axis++) {
+            if (delta[axis] == 0.0f) {
+                if (from[axis] < mins[axis] || from[axis] > maxs[axis]) {
+                    return false;
+                }
+                continue;
+            }
+            float enter = (mins[axis] - from[axis]) / delta[axis];
+            float exit = (maxs[axis] - from[axis]) / delta[axis];
+            t0 = std::max(t0, std::min(enter, exit));
+            t1 = std::min(t1, std::max(enter, exit));
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Appends the proxies of cells [minX, maxX] of row y.
+     */
+    void AppendRow(int y, int minX, int maxX, std::vector<int>& result) const {
+        auto byKey = [](const CellEntry& entry, int64_t key) { return entry.key < key; };
+        // Cells of one row are contiguous in key order
+        auto it = std::lower_bound(entries.begin(), entries.end(), CellKey(minX, y), byKey);
+        int64_t lastKey = CellKey(maxX, y);
+        for (; it != entries.end() && it->key <= lastKey; ++it) {
+            result.push_back(it->proxy);
+        }
+    }
+
+    /**
+     * @brief Adds the oversized proxies and removes duplicates from a query result.
+     */
+    void FinishQuery(std::vector<int>& result) const {
+        result.insert(result.end(), oversized.begin(), oversized.end());
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+    }
+
+public:
+    /**
+     * @brief Constructs a BroadphaseGrid.
+     * @param cellSize Side of a cell in pixels (default 128).
+     * @param maxCellsPerProxy Cells a proxy may cover before it is treated as oversized (default 64).
+     */
+    BroadphaseGrid(float cellSize = 128.0f, int maxCellsPerProxy = 64)
+        : cellSize(cellSize), maxCellsPerProxy(maxCellsPerProxy) {}
+
+    /**
+     * @brief Rebuilds the grid from a new set of bounds.
+     * @param newBounds Bounds of every proxy, indexed by proxy id.
+     */
+    void Build(const std::vector<Aabb>& newBounds) {
+        bounds = newBounds;
+        ranges.resize(bounds.size());
+        entries.clear();
+        oversized.clear();
+        extent = { 0, 0, -1, -1 };
+
+        for (size_t i = 0; i < bounds.size(); i++) {
+            const Aabb& box = bounds[i];
+            CellRange range = { ToCell(box.minX), ToCell(box.minY),
+                ToCell(box.maxX), ToCell(box.maxY) };
+            ranges[i] = range;
+
+            long long cellCount = static_cast<long long>(range.maxX - range.minX + 1)
+                * (range.maxY - range.minY + 1);
+            if (cellCount > maxCellsPerProxy) {
+                oversized.push_back(static_cast<int>(i));
+                continue;
+            }
+
+            for (int y = range.minY; y <= range.maxY; y++) {
+                for (int x = range.minX; x <= range.maxX; x++) {
+                    entries.push_back({ CellKey(x, y), x, y, static_cast<int>(i) });
+                }
+            }
+            if (extent.minX > extent.maxX) {
+                extent = range;
+            }
+            else {
+                extent.minX = std::min(extent.minX, range.minX);
+                extent.minY = std::min(extent.minY, range.minY);
+                extent.maxX = std::max(extent.maxX, range.maxX);
+                extent.maxY = std::max(extent.maxY, range.maxY);
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(),
+            [](const CellEntry& l, const CellEntry& r) {
+                return l.key < r.key || (l.key == r.key && l.proxy < r.proxy);
+            });
+    }
+
+    /**
+     * @brief Gets the bounds the grid was built from.
+     */
+    const std::vector<Aabb>& GetBounds() const {
+        return bounds;
+    }
+
+    /**
+     * @brief Collects every proxy whose cells overlap a rectangle.
+     *
+     * Results are coarse: callers still need an exact test against the
+     * returned proxies. Each proxy appears once, in increasing index order.
+     *
+     * @param box Area to search.
+     * @param result Output vector, cleared before use.
+     */
+    void Query(const Aabb& box, std::vector<int>& result) const {
+        result.clear();
+        int minX = std::max(ToCell(box.minX), extent.minX);
+        int minY = std::max(ToCell(box.minY), extent.minY);
+        int maxX = std::min(ToCell(box.maxX), extent.maxX);
+        int maxY = std::min(ToCell(box.maxY), extent.maxY);
+
+        for (int y = minY; y <= maxY; y++) {
+            AppendRow(y, minX, maxX, result);
+        }
+        FinishQuery(result);
+    }
+
+    /**
+     * @brief Collects every proxy in the cells crossed by a segment.
+     *
+     * Walks the grid cell by cell from the start to the end point, so long
+     * diagonal segments do not visit their whole bounding box. Results are
+     * coarse, unique and in increasing index order.
+     *
+     * @param x0, y0 Start point.
+     * @param x1, y1 End point.
+     * @param result Output vector, cleared before use.
+     */
+    void QuerySegment(float x0, float y0, float x1, float y1, std::vector<int>& result) const {
+        result.clear();
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        // Only the part of the segment over cells with entries is walked
+        float t0;
+        float t1;
+        if (!ClipToExtent(x0, y0, x1 - x0, y1 - y0, t0, t1)) {
+            FinishQuery(result);
+            return;
+        }
+        float clippedX0 = x0 + (x1 - x0) * t0;
+        float clippedY0 = y0 + (y1 - y0) * t0;
+        x1 = x0 + (x1 - x0) * t1;
+        y1 = y0 + (y1 - y0) * t1;
+        x0 = clippedX0;
+        y0 = clippedY0;
+
+        int x = ToCell(x0);
+        int y = ToCell(y0);
+        int endX = ToCell(x1);
+        int endY = ToCell(y1);
+        float dx = x1 - x0;
+        float dy = y1 - y0;
+        int stepX = dx > 0.0f ? 1 : (dx < 0.0f ? -1 : 0);
+        int stepY = dy > 0.0f ? 1 : (dy < 0.0f ? -1 : 0);
+
+        // Segment parameter at which the next column / row boundary is crossed
+        float nextX = stepX > 0 ? ((x + 1) * cellSize - x0) / dx
+            : (stepX < 0 ? (x * cellSize - x0) / dx : infinity);
+        float nextY = stepY > 0 ? ((y + 1) * cellSize - y0) / dy
+            : (stepY < 0 ? (y * cellSize - y0) / dy : infinity);
+        float deltaX = stepX != 0 ? cellSize / std::abs(dx) : infinity;
+        float deltaY = stepY != 0 ? cellSize / std::abs(dy) : infinity;
+
+        int steps = std::abs(endX - x) + std::abs(endY - y);
+        for (int i = 0; i <= steps; i++) {
+            AppendRow(y, x, x, result);
+            if (nextX < nextY) {
+                x += stepX;
+                nextX += deltaX;
+            }
+            else {
+                y += stepY;
+                nextY += deltaY;
+            }
+        }
+        FinishQuery(result);
+    }
+
+    /**
+     * @brief Collects every candidate pair, sorted by (a, b).
+     * @param pairs Output vector, cleared before use.
+     */
+    void FindPairs(std::vector<ProxyPair>& pairs) const {
+        pairs.clear();
+
+        size_t runStart = 0;
+        while (runStart < entries.size()) {
+            size_t runEnd = runStart + 1;
+            while (runEnd < entries.size() && entries[runEnd].key == entries[runStart].key) {
+                runEnd++;
+            }
+
+            for (size_t i = runStart; i < runEnd; i++) {
+                const CellRange& aRange = ranges[entries[i].proxy];
+                for (size_t j = i + 1; j < runEnd; j++) {
+                    const CellRange& bRange = ranges[entries[j].proxy];
+
+                    // Only report the pair from the first cell both proxies share
+                    if (entries[i].cellX != std::max(aRange.minX, bRange.minX)
+                        || entries[i].cellY != std::max(aRange.minY, bRange.minY)) {
+                        continue;
+                    }
+                    pairs.push_back({ entries[i].proxy, entries[j].proxy });
+                }
+            }
+            runStart = runEnd;
+        }
+
+        for (size_t i = 0; i < oversized.size(); i++) {
+            int big = oversized[i];
+            for (int other = 0; other < static_cast<int>(bounds.size()); other++) {
+                if (other == big) {
+                    continue;
+                }
+                // Two oversized proxies are paired once, by the lower one
+                if (other < big && std::binary_search(oversized.begin(), oversized.end(), other)) {
+                    continue;
+                }
+                pairs.push_back({ std::min(big, other), std::max(big, other) });
+            }
+        }
+
+        std::sort(pairs.begin(), pairs.end(), [](const ProxyPair& l, const ProxyPair& r) {
+            return l.a < r.a || (l.a == r.a && l.b < r.b);
+        });
+    }
+};
+
+#endif // BROADPHASEGRID_HPP
+
+/** @} */ // end of group
@@ -0,0 +1,197 @@
+/**
+ * @file ContactPairCache.hpp
+ * @brief Persistent set of touching entity pairs used to find contact begin and end
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup Physics
+ */
+
+#ifndef CONTACTPAIRCACHE_HPP
+#define CONTACTPAIRCACHE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "../ECS/ECS.hpp"
+
+/**
+ * @brief Remembers which entity pairs touched on the previous step.
+ *
+ * Pairs are keyed by their entity ids, lower id first, in an open addressing
+ * hash table with linear probing stored in one flat array. Every step the
+ * contacts are touched with Touch, which tells whether the pair is new, and
+ * CollectEnded reports and removes the pairs that were not touched.
+ * Removal shifts the following entries back, so the table never holds
+ * tombstones and lookups stay short.
+ */
+class ContactPairCache {
+private:
+    /** @brief Key of an empty slot, no pair of valid ids packs to it */
+    static constexpr uint64_t EMPTY_KEY = ~0ull;
+
+    /** @brief Smallest table size, a power of two */
+    static constexpr size_t MIN_CAPACITY = 64;
+
+    /**
+     * @brief One table entry.
+     */
+    struct Slot {
+        uint64_t key = EMPTY_KEY; /**< Packed entity ids, EMPTY_KEY when free */
+        uint32_t stamp = 0; /**< Step in which the pair was last touched */
+        Entity a; /**< Entity with the lower id */
+        Entity b; /**< Entity with the higher id */
+
+        Slot() : a(-1), b(-1) {
+            a.registry = nullptr;
+            b.registry = nullptr;
+        }
+    };
+
+    std::vector<Slot> slots; /**< Table, its size is zero or a power of two */
+    size_t count = 0; /**< Pairs stored */
+    uint32_t stamp = 0; /**< Current step */
+    std::vector<uint64_t> endedKeys; /**< Scratch buffer of CollectEnded */
+
+    /**
+     * @brief Packs the entity ids of a pair, lower id first.
+     */
+    static uint64_t PairKey(const Entity& a, const Entity& b) {
+        uint64_t low = static_cast<uint32_t>(std::min(a.GetId(), b.GetId()));
+        uint64_t high = static_cast<uint32_t>(std::max(a.GetId(), b.GetId()));
+        return (low << 32) | high;
+    }
+
+    /**
+     * @brief Mixes the bits of a key so consecutive ids spread over the table.
+     */
+    static uint64_t Hash(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdull;
+        key ^= key >> 33;
+        return key;
+    }
+
+    /**
+     * @brief Gets the slot holding a key, or the free slot where it would go.
+     */
+    size_t Find(uint64_t key) const {
+        size_t mask = slots.size() - 1;
+        size_t index = Hash(key) & mask;
+        while (slots[index].key != EMPTY_KEY && slots[index].key != key) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    /**
+     * @brief Doubles the table and inserts every pair again.
+     */
+    void Grow() {
+        std::vector<Slot> old;
+        old.swap(slots);
+        slots.resize(std::max(MIN_CAPACITY, old.size() * 2));
+        for (const auto& slot : old) {
+            if (slot.key != EMPTY_KEY) {
+                slots[Find(slot.key)] = slot;
+            }
+        }
+    }
+
+    /**
+     * @brief Removes a key, shifting back the entries probed past it.
+     */
+    void Erase(uint64_t key) {
+        size_t mask = slots.size() - 1;
+        size_t hole = Find(key);
+        if (slots[hole].key == EMPTY_KEY) {
+            return;
+        }
+
+        size_t next = (hole + 1) & mask;
+        while (slots[next].key != EMPTY_KEY) {
+            // An entry may fill the hole if the hole lies between its home slot and it
+            size_t home = Hash(slots[next].key) & mask;
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = slots[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots[hole] = Slot();
+        count--;
+    }
+
+public:
+    /**
+     * @brief Starts a new step; pairs not touched during it are reported by CollectEnded.
+     */
+    void BeginStep() {
+        stamp++;
+    }
+
+    /**
+     * @brief Marks a pair as touching during the current step.
+     * @return True if the pair did not touch on the previous step.
+     */
+    bool Touch(const Entity& a, const Entity& b) {
+        // Keeps the load factor under 3/4
+        if ((count + 1) * 4 > slots.size() * 3) {
+            Grow();
+        }
+
+        uint64_t key = PairKey(a, b);
+        Slot& slot = slots[Find(key)];
+        if (slot.key == key) {
+            slot.stamp = stamp;
+            return false;
+        }
+
+        slot.key = key;
+        slot.stamp = stamp;
+        slot.a = a < b ? a : b;
+        slot.b = a < b ? b : a;
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Reports and forgets the pairs not touched during the current step.
+     * @param ended Output pairs in entity id order, cleared before use.
+     */
+    void CollectEnded(std::vector<std::pair<Entity, Entity>>& ended) {
+        ended.clear();
+        endedKeys.clear();
+        for (const auto& slot : slots) {
+            if (slot.key != EMPTY_KEY && slot.stamp != stamp) {
+                endedKeys.push_back(slot.key);
+            }
+        }
+
+        // Table order depends on the hash, report in id order instead
+        std::sort(endedKeys.begin(), endedKeys.end());
+        for (uint64_t key : endedKeys) {
+            const Slot& slot = slots[Find(key)];
+            ended.push_back({ slot.a, slot.b });
+        }
+        for (uint64_t key : endedKeys) {
+            Erase(key);
+        }
+    }
+
+    /**
+     * @brief Forgets every pair without reporting it, used when the scene is unloaded.
+     */
+    void Clear() {
+        slots.clear();
+        count = 0;
+    }
+
+    /**
+     * @brief Gets the number of pairs stored.
+     */
+    size_t Size() const {
+        return count;
+    }
+};
+
+#endif // CONTACTPAIRCACHE_HPP
@@ -0,0 +1,213 @@
+/**
+ * @file ContactSolver.hpp
+ * @brief Batched penetration solver over a list of box contacts
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup Physics
+ */
+
+#ifndef CONTACTSOLVER_HPP
+#define CONTACTSOLVER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "BroadphaseGrid.hpp"
+
+/**
+ * @brief Contact between two solver bodies, resolved along a single axis.
+ */
+struct ContactManifold {
+    int pusher; /**< Body that stays in place */
+    int pushed; /**< Body moved out of the pusher */
+    int axis; /**< 0 to separate along x, 1 along y */
+    float sign; /**< 1 if the pushed body moves towards +axis, -1 otherwise */
+};
+
+/**
+ * @brief Separates overlapping boxes from a contact list in a few iterations.
+ *
+ * Bodies and contacts are stored in contiguous arrays. The axis of every
+ * contact is chosen once, from the positions the bodies had last frame:
+ * the axis on which they were apart is the side they came from. Bodies
+ * already overlapping last frame use the axis of least penetration.
+ *
+ * Each iteration walks all contacts and moves the pushed body out of the
+ * pusher by the current depth. A body resting on another one that is itself
+ * pushed out of the ground is corrected again on the next iteration, so
+ * stacks settle in the same frame regardless of contact order.
+ */
+class ContactSolver {
+public:
+    /** @brief Flags of the directions a body was pushed in */
+    enum BlockedSide : uint8_t {
+        BLOCKED_LEFT = 1, /**< Pushed towards -x */
+        BLOCKED_RIGHT = 2, /**< Pushed towards +x */
+        BLOCKED_UP = 4, /**< Pushed towards -y */
+        BLOCKED_DOWN = 8 /**< Pushed towards +y */
+    };
+
+private:
+    std::vector<Aabb> boxes; /**< Current bounds of every body */
+    std::vector<Aabb> previousBoxes; /**< Bounds of every body last frame */
+    std::vector<uint8_t> blocked; /**< BlockedSide flags of every body */
+    std::vector<ContactManifold> manifolds; /**< Contacts in insertion order */
+
+    /**
+     * @brief Gets the overlap of two boxes on one axis, negative when apart.
+     */
+    static float Overlap(const Aabb& a, const Aabb& b, int axis) {
+        if (axis == 0) {
+            return std::min(a.maxX, b.maxX) - std::max(a.minX, b.minX);
+        }
+        return std::min(a.maxY, b.maxY) - std::max(a.minY, b.minY);
+    }
+
+    /**
+     * @brief Gets the center of a box on one axis, doubled to avoid the division.
+     */
+    static float Center2(const Aabb& box, int axis) {
+        return axis == 0 ? box.minX + box.maxX : box.minY + box.maxY;
+    }
+
+public:
+    /**
+     * @brief Removes every body and contact, keeping the allocations.
+     */
+    void Clear() {
+        boxes.clear();
+        previousBoxes.clear();
+        blocked.clear();
+        manifolds.clear();
+    }
+
+    /**
+     * @brief Adds a body to the solver.
+     * @param box Current bounds of the collider.
+     * @param previousBox Bounds of the collider last frame.
+     * @return Index of the body.
+     */
+    int AddBody(const Aabb& box, const Aabb& previousBox) {
+        boxes.push_back(box);
+        previousBoxes.push_back(previousBox);
+        blocked.push_back(0);
+        return static_cast<int>(boxes.size()) - 1;
+    }
+
+    /**
+     * @brief Adds a contact in which one body is pushed out of the other.
+     * @param pusher Body that stays in place.
+     * @param pushed Body moved out of the pusher.
+     */
+    void AddContact(int pusher, int pushed) {
+        const Aabb& previousA = previousBoxes[pusher];
+        const Aabb& previousB = previousBoxes[pushed];
+        bool wasApartX = Overlap(previousA, previousB, 0) <= 0.0f;
+        bool wasApartY = Overlap(previousA, previousB, 1) <= 0.0f;
+
+        int axis;
+        if (wasApartY && !wasApartX) {
+            axis = 1;
+        }
+        else if (wasApartX && !wasApartY) {
+            axis = 0;
+        }
+        else {
+            // Diagonal approach or overlapping already, take the shallow axis
+            axis = Overlap(boxes[pusher], boxes[pushed], 0)
+                < Overlap(boxes[pusher], boxes[pushed], 1) ? 0 : 1;
+        }
+
+        float sign = Center2(previousB, axis) < Center2(previousA, axis) ? -1.0f : 1.0f;
+        manifolds.push_back({ pusher, pushed, axis, sign });
+    }
+
+    /**
+     * @brief Moves the pushed bodies out of their contacts.
+     * @param iterations Maximum passes over the contact list.
+     *
+     * Stops early once a pass moves nothing.
+     */
+    void Solve(int iterations) {
+        for (int iteration = 0; iteration < iterations; iteration++) {
+            bool hasMoved = false;
+            for (const auto& manifold : manifolds) {
+                const Aabb& a = boxes[manifold.pusher];
+                Aabb& b = boxes[manifold.pushed];
+                // Touching edges are not a contact, same as the narrowphase
+                if (Overlap(a, b, 0) <= 0.0f || Overlap(a, b, 1) <= 0.0f) {
+                    continue;
+                }
+
+                float delta;
+                if (manifold.axis == 0) {
+                    delta = manifold.sign > 0.0f ? a.maxX - b.minX : a.minX - b.maxX;
+                    b.minX += delta;
+                    b.maxX += delta;
+                    blocked[manifold.pushed] |= manifold.sign > 0.0f ? BLOCKED_RIGHT : BLOCKED_LEFT;
+                }
+                else {
+                    delta = manifold.sign > 0.0f ? a.maxY - b.minY : a.minY - b.maxY;
+                    b.minY += delta;
+                    b.maxY += delta;
+                    blocked[manifold.pushed] |= manifold.sign > 0.0f ? BLOCKED_DOWN : BLOCKED_UP;
+                }
+                hasMoved = true;
+            }
+            if (!hasMoved) {
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the solved bounds of a body.
+     */
+    const Aabb& GetBox(int body) const {
+        return boxes[body];
+    }
+
+    /**
+     * @brief Gets the BlockedSide flags of a body, 0 if it was never pushed.
+     */
+    uint8_t GetBlocked(int body) const {
+        return blocked[body];
+    }
+
+    /**
+     * @brief Removes the velocity that drove a body into the sides it was pushed from.
+     * @param blocked BlockedSide flags of the body.
+     * @param velocityX Velocity of the body on x, zeroed if it moves into a pusher.
+     * @param velocityY Velocity of the body on y, zeroed if it moves into a pusher.
+     */
+    static void StopBlockedVelocity(uint8_t blocked, float& velocityX, float& velocityY) {
+        if ((blocked & BLOCKED_UP) && velocityY > 0.0f) {
+            velocityY = 0.0f;
+        }
+        if ((blocked & BLOCKED_DOWN) && velocityY < 0.0f) {
+            velocityY = 0.0f;
+        }
+        if ((blocked & BLOCKED_LEFT) && velocityX > 0.0f) {
+            velocityX = 0.0f;
+        }
+        if ((blocked & BLOCKED_RIGHT) && velocityX < 0.0f) {
+            velocityX = 0.0f;
+        }
+    }
+
+    /**
+     * @brief Gets the number of bodies added since the last Clear.
+     */
+    int GetBodyCount() const {
+        return static_cast<int>(boxes.size());
+    }
+
+    /**
+     * @brief Gets the number of contacts added since the last Clear.
+     */
+    int GetContactCount() const {
+        return static_cast<int>(manifolds.size());
+    }
+};
+
+#endif // CONTACTSOLVER_HPP
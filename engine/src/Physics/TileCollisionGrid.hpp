@@ -0,0 +1,245 @@
+/**
+ * @file TileCollisionGrid.hpp
+ * @brief Static map collision stored per tile instead of as entities
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup Physics
+ */
+
+#ifndef TILECOLLISIONGRID_HPP
+#define TILECOLLISIONGRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BroadphaseGrid.hpp"
+
+/**
+ * @brief Solid box returned by a TileCollisionGrid query.
+ */
+struct TileSolid {
+    Aabb box; /**< World bounds of the solid */
+    const std::string* tag; /**< Name of the Tiled object, nullptr for layer tiles */
+};
+
+/**
+ * @brief Collision geometry of a Tiled map laid over its tile grid.
+ *
+ * Solids come from two places: tiles of the map's collision layer mark
+ * whole cells as solid, and rectangles of the "colliders" object group are
+ * bucketed into every cell they cover. A query turns a box into a range of
+ * cells and only looks at those cells, so the cost does not depend on how
+ * many colliders the map has.
+ *
+ * Geometry outside the map bounds is clamped to the border cells and boxes
+ * with an infinite or NaN edge overlap nothing. Queries
+ * reuse an internal buffer, so they must all run on the same thread.
+ */
+class TileCollisionGrid {
+private:
+    /** @brief Rectangle from the colliders object group */
+    struct TileRect {
+        Aabb box; /**< World bounds */
+        std::string tag; /**< Object name */
+    };
+
+    int tileWidth = 0; /**< Cell width in pixels */
+    int tileHeight = 0; /**< Cell height in pixels */
+    int columns = 0; /**< Cells per row */
+    int rows = 0; /**< Cells per column */
+    std::vector<uint8_t> solidCells; /**< 1 for cells filled by the collision layer */
+    std::vector<TileRect> rects; /**< Rectangles from the object group */
+    std::vector<int> cellRectStart; /**< Start of every cell in cellRects, plus end */
+    std::vector<int> cellRects; /**< Rectangle indices bucketed by cell */
+    mutable std::vector<int> rectScratch; /**< Rectangles touched by the current query */
+
+    /**
+     * @brief Gets the cell of a coordinate, clamped to one cell around the map.
+     *
+     * Clamping happens in float because the cast is undefined past the int
+     * range; the caller has already rejected NaN.
+     */
+    static int ToCell(float value, int size, int count) {
+        float cell = std::floor(value / static_cast<float>(size));
+        return static_cast<int>(std::max(-1.0f, std::min(static_cast<float>(count), cell)));
+    }
+
+    /**
+     * @brief Converts a box to the inclusive range of cells it overlaps.
+     * @return False if the box is entirely outside the map or not finite.
+     */
+    bool CellRange(const Aabb& box, int& minCol, int& minRow, int& maxCol, int& maxRow) const {
+        if (columns == 0 || rows == 0) {
+            return false;
+        }
+        // Scripts and runaway bodies can produce these, they overlap nothing
+        if (!std::isfinite(box.minX) || !std::isfinite(box.minY)
+            || !std::isfinite(box.maxX) || !std::isfinite(box.maxY)) {
+            return false;
+        }
+        // Edges that only touch a cell do not overlap it
+        minCol = ToCell(std::floor(box.minX), tileWidth, columns);
+        minRow = ToCell(std::floor(box.minY), tileHeight, rows);
+        maxCol = ToCell(std::ceil(box.maxX) - 1.0f, tileWidth, columns);
+        maxRow = ToCell(std::ceil(box.maxY) - 1.0f, tileHeight, rows);
+
+        if (maxCol < 0 || maxRow < 0 || minCol >= columns || minRow >= rows) {
+            return false;
+        }
+        minCol = std::max(minCol, 0);
+        minRow = std::max(minRow, 0);
+        maxCol = std::min(maxCol, columns - 1);
+        maxRow = std::min(maxRow, rows - 1);
+        return minCol <= maxCol && minRow <= maxRow;
+    }
+
+public:
+    /**
+     * @brief Removes every solid and forgets the map size.
+     */
+    void Clear() {
+        tileWidth = 0;
+        tileHeight = 0;
+        columns = 0;
+        rows = 0;
+        solidCells.clear();
+        rects.clear();
+        cellRectStart.clear();
+        cellRects.clear();
+    }
+
+    /**
+     * @brief Sizes the grid for a map, removing any previous solids.
+     * @param tileWidth Width of a tile in pixels.
+     * @param tileHeight Height of a tile in pixels.
+     * @param columns Map width in tiles.
+     * @param rows Map height in tiles.
+     */
+    void Reset(int tileWidth, int tileHeight, int columns, int rows) {
+        Clear();
+        if (tileWidth <= 0 || tileHeight <= 0 || columns <= 0 || rows <= 0) {
+            return;
+        }
+        this->tileWidth = tileWidth;
+        this->tileHeight = tileHeight;
+        this->columns = columns;
+        this->rows = rows;
+        solidCells.assign(static_cast<size_t>(columns) * rows, 0);
+        cellRectStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+    }
+
+    /**
+     * @brief Checks whether the grid holds a map.
+     */
+    bool IsEnabled() const {
+        return columns > 0 && rows > 0;
+    }
+
+    /**
+     * @brief Marks one cell as solid.
+     */
+    void SetSolid(int column, int row) {
+        if (column < 0 || row < 0 || column >= columns || row >= rows) {
+            return;
+        }
+        solidCells[static_cast<size_t>(row) * columns + column] = 1;
+    }
+
+    /**
+     * @brief Adds a collider rectangle. Call Finalize once all are added.
+     */
+    void AddRect(int x, int y, int width, int height, const std::string& tag) {
+        Aabb box = { static_cast<float>(x), static_cast<float>(y),
+            static_cast<float>(x + width), static_cast<float>(y + height) };
+        rects.push_back({ box, tag });
+    }
+
+    /**
+     * @brief Buckets the collider rectangles into the cells they cover.
+     */
+    void Finalize() {
+        if (!IsEnabled()) {
+            return;
+        }
+        size_t cellCount = static_cast<size_t>(columns) * rows;
+        std::vector<int> counts(cellCount, 0);
+        int minCol, minRow, maxCol, maxRow;
+
+        for (const auto& rect : rects) {
+            if (!CellRange(rect.box, minCol, minRow, maxCol, maxRow)) {
+                continue;
+            }
+            for (int row = minRow; row <= maxRow; row++) {
+                for (int col = minCol; col <= maxCol; col++) {
+                    counts[static_cast<size_t>(row) * columns + col]++;
+                }
+            }
+        }
+
+        cellRectStart.assign(cellCount + 1, 0);
+        for (size_t i = 0; i < cellCount; i++) {
+            cellRectStart[i + 1] = cellRectStart[i] + counts[i];
+        }
+        cellRects.assign(cellRectStart[cellCount], 0);
+
+        std::vector<int> fill(cellRectStart.begin(), cellRectStart.end() - 1);
+        for (size_t i = 0; i < rects.size(); i++) {
+            if (!CellRange(rects[i].box, minCol, minRow, maxCol, maxRow)) {
+                continue;
+            }
+            for (int row = minRow; row <= maxRow; row++) {
+                for (int col = minCol; col <= maxCol; col++) {
+                    cellRects[fill[static_cast<size_t>(row) * columns + col]++] = static_cast<int>(i);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Collects every solid overlapping a box.
+     *
+     * Layer cells come first in row-major order, followed by collider
+     * rectangles in load order; each rectangle appears once.
+     *
+     * @param box Area to search.
+     * @param result Output vector, cleared before use.
+     */
+    void QuerySolids(const Aabb& box, std::vector<TileSolid>& result) const {
+        result.clear();
+        int minCol, minRow, maxCol, maxRow;
+        if (!CellRange(box, minCol, minRow, maxCol, maxRow)) {
+            return;
+        }
+
+        rectScratch.clear();
+        for (int row = minRow; row <= maxRow; row++) {
+            for (int col = minCol; col <= maxCol; col++) {
+                size_t cell = static_cast<size_t>(row) * columns + col;
+                if (solidCells[cell]) {
+                    float x = static_cast<float>(col * tileWidth);
+                    float y = static_cast<float>(row * tileHeight);
+                    result.push_back({ { x, y, x + tileWidth, y + tileHeight }, nullptr });
+                }
+                rectScratch.insert(rectScratch.end(), cellRects.begin() + cellRectStart[cell],
+                    cellRects.begin() + cellRectStart[cell + 1]);
+            }
+        }
+
+        std::sort(rectScratch.begin(), rectScratch.end());
+        rectScratch.erase(std::unique(rectScratch.begin(), rectScratch.end()), rectScratch.end());
+        for (int index : rectScratch) {
+            result.push_back({ rects[index].box, &rects[index].tag });
+        }
+    }
+
+    /**
+     * @brief Gets the number of solid cells and rectangles, for logging.
+     */
+    int GetSolidCount() const {
+        return static_cast<int>(std::count(solidCells.begin(), solidCells.end(), 1) + rects.size());
+    }
+};
+
+#endif // TILECOLLISIONGRID_HPP
@@ -0,0 +1,104 @@
+#include "Profiler.hpp"
+
+#ifdef ENABLE_PROFILER
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+Profiler::Profiler() {
+	origin = std::chrono::steady_clock::now();
+}
+
+Profiler::~Profiler() {
+}
+
+Profiler& Profiler::GetInstance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+int64_t Profiler::Now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - origin).count();
+}
+
+ProfileThreadBuffer* Profiler::RegisterThread() {
+	auto buffer = std::make_unique<ProfileThreadBuffer>();
+	buffer->events.resize(BUFFER_SIZE);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	buffer->threadId = static_cast<int>(buffers.size());
+	buffers.push_back(std::move(buffer));
+	return buffers.back().get();
+}
+
+void Profiler::Record(const char* name, int64_t start, int64_t end) {
+	thread_local ProfileThreadBuffer* buffer = RegisterThread();
+
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	ProfileEvent& event = buffer->events[index % BUFFER_SIZE];
+	event.name = name;
+	event.start = start;
+	event.duration = end - start;
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+// Writes a name as a JSON string
+static void WriteJsonString(std::ofstream& file, const char* text) {
+	file << '"';
+	for (const char* c = text; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\') {
+			file << '\\';
+		}
+		file << *c;
+	}
+	file << '"';
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) {
+	std::ofstream file(path);
+	if (!file) {
+		std::cerr << "[PROFILER] Could not create " << path << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	file << std::fixed << std::setprecision(3);
+	file << "{\"traceEvents\":[";
+	bool isFirst = true;
+	size_t eventCount = 0;
+	for (const auto& buffer : buffers) {
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t count = std::min<uint64_t>(written, BUFFER_SIZE);
+		for (uint64_t i = written - count; i < written; i++) {
+			const ProfileEvent& event = buffer->events[i % BUFFER_SIZE];
+			if (!isFirst) {
+				file << ',';
+			}
+			isFirst = false;
+
+			// Chrome expects microseconds
+			file << "\n{\"name\":";
+			WriteJsonString(file, event.name);
+			file << ",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":" << event.start / 1000.0
+				<< ",\"dur\":" << event.duration / 1000.0
+				<< ",\"pid\":1,\"tid\":" << buffer->threadId << '}';
+		}
+		eventCount += count;
+	}
+	file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	std::cout << "[PROFILER] Wrote " << eventCount << " events to " << path << std::endl;
+	return static_cast<bool>(file);
+}
+
+void Profiler::Clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto& buffer : buffers) {
+		buffer->written.store(0, std::memory_order_release);
+	}
+}
+
+#endif // ENABLE_PROFILER
@@ -0,0 +1,167 @@
+/**
+ * @file Profiler.hpp
+ * @brief Scoped CPU profiler exporting Chrome trace_event JSON
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup Profiler
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+/**
+ * @defgroup Profiler Profiler
+ * @{
+ * @brief Measures how long engine scopes take on every thread
+ *
+ * Scopes are marked with PROFILE_SCOPE("Name"). The profiler only exists
+ * when the engine is built with ENABLE_PROFILER (make profile); otherwise
+ * the macros expand to nothing and no profiler code is compiled.
+ *
+ * The resulting file opens in chrome://tracing or https://ui.perfetto.dev.
+ */
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One finished scope.
+ */
+struct ProfileEvent {
+    const char* name = nullptr; /**< Scope name, must be a string literal */
+    int64_t start = 0; /**< Start in nanoseconds since the profiler was created */
+    int64_t duration = 0; /**< Duration in nanoseconds */
+};
+
+/**
+ * @brief Ring buffer of the events of one thread.
+ *
+ * Only the owning thread writes, so recording takes no lock. The write
+ * counter is published with release ordering for the thread that dumps
+ * the trace; once the buffer is full the oldest events are overwritten.
+ */
+struct ProfileThreadBuffer {
+    std::vector<ProfileEvent> events; /**< Fixed size storage */
+    std::atomic<uint64_t> written{ 0 }; /**< Events written since the last Clear */
+    int threadId = 0; /**< Sequential id shown as tid in the trace */
+};
+
+/**
+ * @class Profiler
+ * @brief Singleton collecting the scopes of every thread.
+ *
+ * Each thread registers its buffer the first time it records; the buffers
+ * belong to the profiler so they outlive the threads. WriteChromeTrace and
+ * Clear should be called from the main thread while the JobPool is idle,
+ * events being written during the dump may be missing or torn.
+ */
+class Profiler {
+private:
+    /** @brief Events kept per thread */
+    static constexpr int BUFFER_SIZE = 1 << 16;
+
+    std::mutex mutex; ///< Guards the buffer list, only taken when a thread registers or on dump.
+    std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers; ///< One buffer per thread that recorded.
+    std::chrono::steady_clock::time_point origin; ///< Time zero of the trace.
+
+    /**
+     * @brief Creates the profiler, the trace starts now.
+     */
+    Profiler();
+
+    /**
+     * @brief Destroys the profiler.
+     */
+    ~Profiler();
+
+    /**
+     * @brief Creates the buffer of the calling thread.
+     */
+    ProfileThreadBuffer* RegisterThread();
+
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * @brief Gets the profiler instance.
+     */
+    static Profiler& GetInstance();
+
+    /**
+     * @brief Gets the nanoseconds elapsed since the profiler was created.
+     */
+    int64_t Now() const;
+
+    /**
+     * @brief Stores a finished scope in the buffer of the calling thread.
+     * @param name Scope name, must outlive the profiler.
+     * @param start Value of Now() when the scope started.
+     * @param end Value of Now() when the scope ended.
+     */
+    void Record(const char* name, int64_t start, int64_t end);
+
+    /**
+     * @brief Writes the recorded events as Chrome trace_event JSON.
+     * @param path Destination file, overwritten.
+     * @return False if the file could not be written.
+     */
+    bool WriteChromeTrace(const std::string& path);
+
+    /**
+     * @brief Forgets every recorded event.
+     */
+    void Clear();
+};
+
+/**
+ * @class ProfileScope
+ * @brief Records the lifetime of a scope, used through PROFILE_SCOPE.
+ */
+class ProfileScope {
+private:
+    const char* name; ///< Scope name.
+    int64_t start; ///< Time at construction.
+
+public:
+    /**
+     * @brief Starts timing a scope.
+     */
+    explicit ProfileScope(const char* name)
+        : name(name), start(Profiler::GetInstance().Now()) {
+    }
+
+    /**
+     * @brief Records the scope.
+     */
+    ~ProfileScope() {
+        Profiler& profiler = Profiler::GetInstance();
+        profiler.Record(name, start, profiler.Now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/** @brief Times the enclosing scope under a string literal name */
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+
+#endif // ENABLE_PROFILER
+
+/** @} */
+
+#endif // PROFILER_HPP
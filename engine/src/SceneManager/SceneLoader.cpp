@@ -15,9 +15,12 @@
 #include "../Components/ScriptComponent.hpp"
 #include "../Components/SpriteComponent.hpp"
 #include "../Components/TextComponent.hpp"
+#include "../Components/TileLayerComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../Components/VideoComponent.hpp"
 #include "../Game/Game.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Systems/TileCollisionSystem.hpp"
 
 // Constructor
 SceneLoader::SceneLoader() {
@@ -34,6 +37,7 @@ void SceneLoader::LoadScene(const std::string& scenePath, sol::state& lua
 	, std::unique_ptr<AssetManager>& assetManager
 	, std::unique_ptr<ControllerManager>& controllerManager
 	, std::unique_ptr<Registry>& registry, SDL_Renderer* renderer) {
+	PROFILE_SCOPE("SceneLoader::LoadScene");
 
 	// Clears Map
 	entityMap.clear();
@@ -49,6 +53,7 @@ void SceneLoader::LoadScene(const std::string& scenePath, sol::state& lua
 
 	// Check for errors
 	try {
+		PROFILE_SCOPE("SceneLoader::RunSceneScript");
 		lua.script_file(scenePath);
 	}
 	catch (const sol::error& e) {
@@ -60,26 +65,38 @@ void SceneLoader::LoadScene(const std::string& scenePath, sol::state& lua
 
 	sol::table scene = lua["scene"];
 
-	sol::table videos = scene["videos"];
-	LoadVideos(renderer, videos, assetManager);
+	// Headless runs have no renderer, audio or fonts; only the scene data is loaded
+	bool isHeadless = renderer == nullptr;
+	if (isHeadless) {
+		std::cout << "[SCENELOADER] Headless, skipping textures, videos, audio and fonts" << std::endl;
+	}
+
+	if (!isHeadless) {
+		sol::table videos = scene["videos"];
+		LoadVideos(renderer, videos, assetManager);
+	}
 
 	sol::table objects = scene["objects"];
 	LoadObjects(objects, assetManager);
 
-	sol::table sprites = scene["sprites"];
-	LoadSprites(renderer, sprites, assetManager);
+	if (!isHeadless) {
+		sol::table sprites = scene["sprites"];
+		LoadSprites(renderer, sprites, assetManager);
+	}
 
 	sol::table animations = scene["animations"];
 	LoadAnimations(animations, animationManager);
 
-	sol::table music = scene["music"];
-	LoadMusic(music, assetManager);
+	if (!isHeadless) {
+		sol::table music = scene["music"];
+		LoadMusic(music, assetManager);
 
-	sol::table sfx = scene["sfx"];
-	LoadSoundEffects(sfx, assetManager);
+		sol::table sfx = scene["sfx"];
+		LoadSoundEffects(sfx, assetManager);
 
-	sol::table fonts = scene["fonts"];
-	LoadFonts(fonts, assetManager);
+		sol::table fonts = scene["fonts"];
+		LoadFonts(fonts, assetManager);
+	}
 
 	sol::table keys = scene["keys"];
 	LoadKeys(keys, controllerManager);
@@ -88,7 +105,7 @@ void SceneLoader::LoadScene(const std::string& scenePath, sol::state& lua
 	LoadButtons(buttons, controllerManager);
 
 	sol::table maps = scene["maps"];
-	LoadMap(maps, registry);
+	LoadMap(renderer, maps, registry);
 
 	sol::table entities = scene["entities"];
 	LoadEntities(lua, entities, registry);
@@ -98,6 +115,7 @@ void SceneLoader::LoadScene(const std::string& scenePath, sol::state& lua
 
 void SceneLoader::LoadVideos(SDL_Renderer* renderer, const sol::table& videos
 	, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadVideos");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> hasVideo = videos[index];
@@ -118,6 +136,7 @@ void SceneLoader::LoadVideos(SDL_Renderer* renderer, const sol::table& videos
 
 void SceneLoader::LoadObjects(const sol::table& objects
 	, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadObjects");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> hasObjects = objects[index];
@@ -139,6 +158,7 @@ void SceneLoader::LoadObjects(const sol::table& objects
 
 void SceneLoader::LoadSprites(SDL_Renderer* renderer, const sol::table& sprites
 	, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadSprites");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> hasSprite = sprites[index];
@@ -151,14 +171,16 @@ void SceneLoader::LoadSprites(SDL_Renderer* renderer, const sol::table& sprites
 		std::string assetId = sprite["assetId"];
 		std::string filePath = sprite["filePath"];
 
-		assetManager->AddTexture(renderer, assetId, filePath);
+		assetManager->QueueAtlasImage(assetId, filePath);
 
 		index++;
 	}
+	assetManager->BuildTextureAtlas(renderer);
 }
 
 void SceneLoader::LoadAnimations(const sol::table& animations
 	, std::unique_ptr<AnimationManager>& animationManager) {
+	PROFILE_SCOPE("SceneLoader::LoadAnimations");
 	int index = 0;
 	while (true) {
 	sol::optional<sol::table> hasAnimation = animations[index];
@@ -186,6 +208,7 @@ void SceneLoader::LoadAnimations(const sol::table& animations
 // This is to have a channel for the music,
 // and the rest for the sound effects.
 void SceneLoader::LoadMusic(const sol::table& music, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadMusic");
 
 	sol::optional<sol::table> hasMusic = music[0];
 	if (hasMusic == sol::nullopt) {
@@ -201,6 +224,7 @@ void SceneLoader::LoadMusic(const sol::table& music, std::unique_ptr<AssetManage
 }
 
 void SceneLoader::LoadSoundEffects(const sol::table& sounds, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadSoundEffects");
 	
 	int index = 0;
 	while (true) {
@@ -223,6 +247,7 @@ void SceneLoader::LoadSoundEffects(const sol::table& sounds, std::unique_ptr<Ass
 
 void SceneLoader::LoadFonts(const sol::table& fonts
 	, std::unique_ptr<AssetManager>& assetManager) {
+	PROFILE_SCOPE("SceneLoader::LoadFonts");
 
 	int index = 0;
 	while (true) {
@@ -244,6 +269,7 @@ void SceneLoader::LoadFonts(const sol::table& fonts
 
 void SceneLoader::LoadButtons(const sol::table& buttons
 	, std::unique_ptr<ControllerManager>& controllerManager) {
+	PROFILE_SCOPE("SceneLoader::LoadButtons");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> hasButtons = buttons[index];
@@ -263,6 +289,7 @@ void SceneLoader::LoadButtons(const sol::table& buttons
 
 void SceneLoader::LoadKeys(const sol::table& keys
 	, std::unique_ptr<ControllerManager>& controllerManager) {
+	PROFILE_SCOPE("SceneLoader::LoadKeys");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> haskey = keys[index];
@@ -280,8 +307,9 @@ void SceneLoader::LoadKeys(const sol::table& keys
 	}
 }
 
-void SceneLoader::LoadMap(const sol::table map
+void SceneLoader::LoadMap(SDL_Renderer* renderer, const sol::table map
 	, std::unique_ptr<Registry>& registry) {
+	PROFILE_SCOPE("SceneLoader::LoadMap");
 
 	sol::optional<int> hasWidth = map["width"];
 	if (hasWidth != sol::nullopt) {
@@ -333,11 +361,37 @@ void SceneLoader::LoadMap(const sol::table map
 		int columns;
 		xmlTileSetRoot->QueryIntAttribute("columns", &columns);
 
+		// Native tile collision keeps the static map geometry out of the ECS
+		TileCollisionGrid* tileGrid = nullptr;
+		bool useTileCollision = map["tile_collision"].get_or(false);
+		if (useTileCollision && registry->HasSystem<TileCollisionSystem>()) {
+			tileGrid = &registry->GetSystem<TileCollisionSystem>().GetGrid();
+			tileGrid->Reset(tWidth, tHeight, mWidth, mHeight);
+		}
+
+		// Maps opting in get baked chunks instead of tile entities, if the renderer can draw to textures
+		Tilemap* tilemap = nullptr;
+		bool bakeTiles = map["bake_tiles"].get_or(false);
+		if (bakeTiles && (renderer == nullptr || SDL_RenderTargetSupported(renderer))) {
+			tilemap = Game::GetInstance().tilemap.get();
+			tilemap->Reset(tWidth, tHeight, mWidth, mHeight, tileName, columns);
+		}
+
 		//Se obtiene el primer elemento del tipo layer
 		tinyxml2::XMLElement* xmlLayer = xmlRoot->FirstChildElement("layer");
 
 		while (xmlLayer != nullptr) {
-			LoadLayer(registry, xmlLayer, tWidth, tHeight, mWidth, tileName, columns);
+			const char* layerName = xmlLayer->Attribute("name");
+			bool isCollisionLayer = tileGrid != nullptr && layerName != nullptr
+				&& strcmp(layerName, "collision") == 0;
+
+			if (isCollisionLayer) {
+				LoadCollisionLayer(*tileGrid, xmlLayer, mWidth);
+			}
+			// Hidden collision layers only feed the grid
+			if (!isCollisionLayer || xmlLayer->IntAttribute("visible", 1) != 0) {
+				LoadLayer(registry, xmlLayer, tWidth, tHeight, mWidth, tileName, columns, tilemap);
+			}
 			xmlLayer = xmlLayer->NextSiblingElement("layer");
 		}
 
@@ -356,17 +410,28 @@ void SceneLoader::LoadMap(const sol::table map
 			name = objectGroupName;
 
 			if (name.compare("colliders") == 0) {
-				LoadColliders(registry, xmlObjectGroup);
+				LoadColliders(registry, xmlObjectGroup, tileGrid);
 			}
 
 			xmlObjectGroup = xmlObjectGroup->NextSiblingElement("objectgroup");
 		}
+
+		if (tilemap != nullptr) {
+			std::cout << "[SCENELOADER] Tilemap loaded with " << tilemap->GetLayerCount()
+				<< " baked layers" << std::endl;
+		}
+		if (tileGrid != nullptr) {
+			tileGrid->Finalize();
+			std::cout << "[SCENELOADER] Tile collision grid loaded with "
+				<< tileGrid->GetSolidCount() << " solids" << std::endl;
+		}
 	}
 }
 	
 void SceneLoader::LoadLayer(std::unique_ptr<Registry>& registry
     , tinyxml2::XMLElement* layer, int tWidth, int tHeight, int mWidth
-    , const std::string& tileSet, int columns) {
+    , const std::string& tileSet, int columns, Tilemap* tilemap) {
+	PROFILE_SCOPE("SceneLoader::LoadLayer");
 
     tinyxml2::XMLElement* xmldata = layer->FirstChildElement("data");
     const char* data = xmldata->GetText();
@@ -374,6 +439,7 @@ void SceneLoader::LoadLayer(std::unique_ptr<Registry>& registry
     std::stringstream tmpNumber;
     int pos = 0;
     int tileNumber = 0;
+    std::vector<uint32_t> tiles;
 
     // Define bitmask constants
     const uint32_t FLIP_HORIZONTAL = 0x80000000;
@@ -396,7 +462,10 @@ void SceneLoader::LoadLayer(std::unique_ptr<Registry>& registry
                 // Extract the actual tile ID by masking the flip bits
                 uint32_t tileId = encodedTileId & TILE_ID_MASK;
 
-                if (tileId > 0) {
+                if (tilemap != nullptr) {
+                    tiles.push_back(encodedTileId);
+                }
+                else if (tileId > 0) {
                     Entity tile = registry->CreateEntity();
                     tile.AddComponent<TransformComponent>(
                         glm::vec2((tileNumber % mWidth) * tWidth,
@@ -423,9 +492,11 @@ void SceneLoader::LoadLayer(std::unique_ptr<Registry>& registry
             }
             catch (const std::invalid_argument& e) {
                 std::cerr << "Invalid argument in stoi: " << tmpNumber.str() << "\n";
+                tiles.push_back(0);
             }
             catch (const std::out_of_range& e) {
                 std::cerr << "Out of range in stoi: " << tmpNumber.str() << "\n";
+                tiles.push_back(0);
             }
             tmpNumber.str("");
             tmpNumber.clear(); // Clear any flags
@@ -433,10 +504,51 @@ void SceneLoader::LoadLayer(std::unique_ptr<Registry>& registry
         }
         pos++;
     }
+
+    // One entity keeps the layer's place in the draw order
+    if (tilemap != nullptr) {
+        const char* layerName = layer->Attribute("name");
+        int layerIndex = tilemap->AddLayer(layerName != nullptr ? layerName : "", std::move(tiles));
+        Entity anchor = registry->CreateEntity();
+        anchor.AddComponent<TransformComponent>();
+        anchor.AddComponent<SpriteComponent>();
+        anchor.AddComponent<TileLayerComponent>(layerIndex);
+    }
+}
+
+void SceneLoader::LoadCollisionLayer(TileCollisionGrid& tileGrid
+	, tinyxml2::XMLElement* layer, int mWidth) {
+	PROFILE_SCOPE("SceneLoader::LoadCollisionLayer");
+
+	tinyxml2::XMLElement* xmldata = layer->FirstChildElement("data");
+	const char* data = xmldata->GetText();
+	if (data == nullptr) {
+		return;
+	}
+
+	// Flip bits do not matter for collision, any tile marks the cell as solid
+	const uint32_t TILE_ID_MASK = 0x1FFFFFFF;
+	int tileNumber = 0;
+	const char* cursor = data;
+
+	while (*cursor != '\0') {
+		if (!isdigit(*cursor)) {
+			cursor++;
+			continue;
+		}
+		char* end = nullptr;
+		uint32_t encodedTileId = static_cast<uint32_t>(std::strtoul(cursor, &end, 10));
+		if ((encodedTileId & TILE_ID_MASK) > 0) {
+			tileGrid.SetSolid(tileNumber % mWidth, tileNumber / mWidth);
+		}
+		tileNumber++;
+		cursor = end;
+	}
 }
 
 void SceneLoader::LoadColliders(std::unique_ptr<Registry>& registry
-	, tinyxml2::XMLElement* objectGroup) {
+	, tinyxml2::XMLElement* objectGroup, TileCollisionGrid* tileGrid) {
+	PROFILE_SCOPE("SceneLoader::LoadColliders");
 	// Cargar el primer collider
 	tinyxml2::XMLElement* object = objectGroup->FirstChildElement("object");
 
@@ -447,9 +559,6 @@ void SceneLoader::LoadColliders(std::unique_ptr<Registry>& registry
 		int x, y, w, h, gid;
 		const char* spriteStr = nullptr;
 
-		// Crear entidad
-		Entity collider = registry->CreateEntity();
-
 		// Obtener el tag del objecto
 		object->QueryStringAttribute("name", &name);
 		tag = name;
@@ -477,6 +586,16 @@ void SceneLoader::LoadColliders(std::unique_ptr<Registry>& registry
 			}
 		}
 
+		// Colliders without a sprite go to the tile grid when it is enabled
+		if (tileGrid != nullptr && spriteStr == nullptr) {
+			tileGrid->AddRect(x, y, w, h, tag);
+			object = object->NextSiblingElement("object");
+			continue;
+		}
+
+		// Crear entidad
+		Entity collider = registry->CreateEntity();
+
 		// Check if sprite was found
 		if (spriteStr) {
 			collider.AddComponent<SpriteComponent>(std::string(spriteStr), w, h, 0,0);
@@ -496,6 +615,7 @@ void SceneLoader::LoadColliders(std::unique_ptr<Registry>& registry
 
 void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities
 	, std::unique_ptr<Registry>& registry) {
+	PROFILE_SCOPE("SceneLoader::LoadEntities");
 	int index = 0;
 	while (true) {
 		sol::optional<sol::table> hasEntity = entities[index];
@@ -563,10 +683,12 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities
 			//* RigidBodyComponent
 			sol::optional<sol::table> hasRigidbody = components["rigidbody"];
 			if (hasRigidbody != sol::nullopt) {
+				bool isBullet = components["rigidbody"]["is_bullet"].get_or(false);
 				newEntity.AddComponent<RigidBodyComponent>(
 					components["rigidbody"]["is_dynamic"],
 					components["rigidbody"]["is_solid"],
-					components["rigidbody"]["mass"]
+					components["rigidbody"]["mass"],
+					isBullet
 				);
 			}
 
@@ -662,6 +784,9 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities
 			if (hasScript != sol::nullopt) {
 				lua["on_awake"] = sol::nil;
 				lua["on_collision"] = sol::nil;
+				lua["on_collision_enter"] = sol::nil;
+				lua["on_collision_exit"] = sol::nil;
+				lua["on_collisions"] = sol::nil;
 				lua["on_click"] = sol::nil;
 				lua["update"] = sol::nil;
 
@@ -681,6 +806,24 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities
 					onCollision = lua["on_collision"];
 				}
 
+				sol::optional<sol::function> hasOnCollisionEnter = lua["on_collision_enter"];
+				sol::function onCollisionEnter = sol::nil;
+				if (hasOnCollisionEnter != sol::nullopt) {
+					onCollisionEnter = lua["on_collision_enter"];
+				}
+
+				sol::optional<sol::function> hasOnCollisionExit = lua["on_collision_exit"];
+				sol::function onCollisionExit = sol::nil;
+				if (hasOnCollisionExit != sol::nullopt) {
+					onCollisionExit = lua["on_collision_exit"];
+				}
+
+				sol::optional<sol::function> hasOnCollisions = lua["on_collisions"];
+				sol::function onCollisions = sol::nil;
+				if (hasOnCollisions != sol::nullopt) {
+					onCollisions = lua["on_collisions"];
+				}
+
 				sol::optional<sol::function> hasOnClick = lua["on_click"];
 				sol::function onClick = sol::nil;
 				if (hasOnClick != sol::nullopt) {
@@ -695,7 +838,7 @@ void SceneLoader::LoadEntities(sol::state& lua, const sol::table& entities
 				}
 
 				newEntity.AddComponent<ScriptComponent>(onCollision
-					, onClick, update);
+					, onClick, update, onCollisionEnter, onCollisionExit, onCollisions);
 			}
 		}
 
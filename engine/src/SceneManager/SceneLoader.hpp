@@ -17,8 +17,10 @@
 #include <map>
 #include "../AnimationManager/AnimationManager.hpp"
 #include "../AssetManager/AssetManager.hpp"
+#include "../AssetManager/Tilemap.hpp"
 #include "../ControllerManager/ControllerManager.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Physics/TileCollisionGrid.hpp"
 
  /**
   * @class SceneLoader
@@ -123,13 +125,20 @@ private:
 
     /**
      * @brief Loads the map configuration with a Lua table and creates corresponding entities.
+     *
+     * Every tile becomes an entity unless the map sets bake_tiles = true;
+     * its tile layers then go to the game's Tilemap and are drawn as baked
+     * chunks, provided the renderer can render to textures. Baked tiles are
+     * not entities, so scripts and systems cannot find them.
+     *
+     * @param renderer SDL renderer, nullptr when running headless.
      * @param map Lua table with the map configuration data.
      * @param registry Entity registry instance to manage the created entities.
      */
-    void LoadMap(const sol::table map, std::unique_ptr<Registry>& registry);
+    void LoadMap(SDL_Renderer* renderer, const sol::table map, std::unique_ptr<Registry>& registry);
 
     /**
-     * @brief Loads a specific layer of the map from an XML element and creates the corresponding entities.
+     * @brief Loads a specific layer of the map from an XML element into the tilemap or as entities.
      * @param registry Entity registry instance to manage the created entities.
      * @param layer Pointer to the XML element representing the map layer.
      * @param tWidth Width of each tile in pixels.
@@ -137,22 +146,34 @@ private:
      * @param mWidth Width of the map in tiles.
      * @param tileSet Name of the tileset used by the layer.
      * @param columns Number of columns in the tileset.
+     * @param tilemap Tilemap receiving the layer, or nullptr to create one entity per tile.
      */
     void LoadLayer(std::unique_ptr<Registry>& registry, tinyxml2::XMLElement* layer,
         int tWidth, int tHeight, int mWidth,
-        const std::string& tileSet, int columns);
+        const std::string& tileSet, int columns, Tilemap* tilemap = nullptr);
+
+    /**
+     * @brief Marks the cells of a collision tile layer as solid.
+     * @param tileGrid Grid receiving the solid cells.
+     * @param layer Pointer to the XML element representing the map layer.
+     * @param mWidth Width of the map in tiles.
+     */
+    void LoadCollisionLayer(TileCollisionGrid& tileGrid, tinyxml2::XMLElement* layer,
+        int mWidth);
 
     /**
      * @brief Loads colliders from an object group in an XML map file.
      *
      * Parses the specified XML element representing an object group and creates
-     * entities with collider components in the provided registry.
+     * entities with collider components in the provided registry. When a tile
+     * grid is given, colliders without a sprite are added to it instead.
      *
      * @param registry Entity registry instance to manage the created entities.
      * @param objectGroup Pointer to the XML element representing the object group.
+     * @param tileGrid Tile collision grid, or nullptr to create entities for every collider.
      */
     void LoadColliders(std::unique_ptr<Registry>& registry,
-        tinyxml2::XMLElement* objectGroup);
+        tinyxml2::XMLElement* objectGroup, TileCollisionGrid* tileGrid = nullptr);
 
 public:
     /**
@@ -172,12 +193,15 @@ public:
      * @param assetManager Asset management system instance
      * @param controllerManager Input controller management system instance
      * @param registry Entity registry instance
-     * @param renderer SDL renderer instance
+     * @param renderer SDL renderer instance, nullptr in headless mode
      *
      * This method orchestrates the complete scene loading process, including:
      * - Loading all required assets (videos, sprites, music, sound effects, fonts)
      * - Setting up input controls
      * - Creating and configuring entities
+     *
+     * Without a renderer only the scene data is loaded: textures, videos,
+     * audio and fonts are skipped.
      */
     void LoadScene(const std::string& scenePath, sol::state& lua
         , std::unique_ptr<AnimationManager>& animationManager
@@ -40,6 +40,10 @@ void SceneManager::LoadSceneFromScript(const std::string& path
 	}
 }
 
+void SceneManager::AddScene(const std::string& name, const std::string& path) {
+	scenes[name] = path;
+}
+
 void SceneManager::LoadScene() {
 	Game& game = Game::GetInstance();
 	std::string scenePath = scenes[nextScene];
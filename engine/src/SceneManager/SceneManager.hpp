@@ -65,6 +65,13 @@ public:
      */
     void LoadSceneFromScript(const std::string& path, sol::state& lua);
 
+    /**
+     * @brief Adds a scene outside the scenes script, or replaces its path
+     * @param name Name of the scene
+     * @param path Path to the Lua file describing the scene
+     */
+    void AddScene(const std::string& name, const std::string& path);
+
     /**
      * @brief Loads the next scene using the SceneLoader
      *
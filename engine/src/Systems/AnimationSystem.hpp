@@ -14,6 +14,7 @@
 #include "../Components/AnimationComponent.hpp"
 #include "../Components/SpriteComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
 
  /**
   * @brief Represents the system that manages and updates animations for entities.
@@ -41,6 +42,7 @@
          * time elapsed since the animation started and updates the source rectangle for the sprite.
          */
         void Update() {
+            PROFILE_SCOPE("AnimationSystem::Update");
             for (auto entity : GetSystemEntities()) {
                 auto& animation = entity.GetComponent<AnimationComponent>();
                 auto& sprite = entity.GetComponent<SpriteComponent>();
@@ -9,48 +9,409 @@
 #ifndef BOXCOLLISIONSYSTEM_HPP
 #define BOXCOLLISIONSYSTEM_HPP
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 #include <sol/sol.hpp>
 #include "../Components/BoxColliderComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../Components/PropertyComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
 #include "../Components/ScriptComponent.hpp"
 #include "../ECS/ECS.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../Events/CollisionEvent.hpp"
+#include "../Physics/BroadphaseGrid.hpp"
+#include "../Physics/CollisionKernels.hpp"
+#include "../Physics/ContactPairCache.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/JobPool.hpp"
 
  /**
   * @brief Represents the system that manages box collisions between entities.
   *
   * The BoxCollisionSystem detects and manages collisions between entities with
-  * box colliders. It checks for Axis-Aligned Bounding Box (AABB) collisions
-  * and triggers onCollision scripts when collisions occur.
+  * box colliders. Candidate pairs come from a uniform grid broadphase, the
+  * AABB tests run in parallel on the JobPool using SIMD batched kernels over
+  * structure-of-arrays bounds. The contacts and their scripts are then
+  * dispatched on the main thread in entity id order.
+  *
+  * A persistent pair cache classifies the contacts of each step as begin,
+  * stay or end; only begin and end are queued as CollisionEvents, and only
+  * while something handles them. Scripts can define on_collision_enter and on_collision_exit
+  * to run only when a contact changes, instead of on_collision every step.
+  * Scripts defining on_collisions get one call per step with an array of
+  * every entity they touch instead of one on_collision call per contact.
+  *
+  * Pairs in which nothing moves, such as a sleeping body on the ground, are
+  * not tested again: their contact is carried over from the previous step
+  * while both boxes still overlap, so scripts keep being told about it.
+  * Colliders without a dynamic body only count as not moving while their
+  * box stays where it was on the previous step, and a sleeping body that
+  * loses one of its contacts is woken.
   */
 class BoxCollisionSystem : public System {
 private:
+    /** @brief Minimum number of candidate pairs handed to one worker */
+    static const int NARROWPHASE_GRAIN = 256;
+
+    /** @brief Collider data gathered once per frame for the narrowphase */
+    struct BoxProxy {
+        Entity entity; /**< Owner of the collider */
+        const BoxColliderComponent* collider; /**< Collider, used for tag exclusion */
+        const std::string* tag; /**< Tag of the owner or nullptr */
+        bool isSleeping; /**< Owner is a sleeping rigid body */
+        bool isStatic; /**< Owner is not dynamic, has no velocity and kept its box since the last step */
+    };
+
+    /** @brief Buffers owned by one narrowphase chunk */
+    struct ChunkScratch {
+        std::vector<int> candidates; /**< Candidates of the proxy being tested */
+        std::vector<int> hits; /**< Kernel output */
+        std::vector<ProxyPair> contacts; /**< Contacts found by the chunk */
+    };
+
+    BroadphaseGrid broadphase; /**< Candidate pair source */
+    BoxBatchKernel overlapKernel; /**< Batched AABB test picked for this CPU */
+    std::vector<BoxProxy> proxies; /**< Proxies sorted by entity id */
+    std::vector<Aabb> bounds; /**< Bounds of every proxy, fed to the broadphase */
+    BoxBoundsSoA boxes; /**< Same bounds laid out for the batched kernels */
+    std::vector<ProxyPair> pairs; /**< Candidate pairs from the broadphase */
+    std::vector<ChunkScratch> chunkScratch; /**< Per-chunk narrowphase buffers */
+    std::vector<ProxyPair> contacts; /**< Merged contacts of the current frame */
+    std::vector<std::pair<Entity, Entity>> previousContacts; /**< Contacts told to scripts on the previous step */
+    std::vector<ProxyPair> restingContacts; /**< Contacts carried over because nothing in them moves */
+    std::vector<ProxyPair> reportedContacts; /**< Contacts and resting contacts in pair order */
+    std::vector<int> queryCandidates; /**< Broadphase output of spatial queries */
+    std::vector<std::pair<float, int>> queryHits; /**< Distance and proxy of query hits */
+    ContactPairCache pairCache; /**< Pairs touching on the previous step */
+    std::vector<std::pair<Entity, Entity>> endedPairs; /**< Pairs that stopped touching this step */
+    std::vector<std::pair<int, int>> batchedContacts; /**< Proxy and touched proxy for on_collisions scripts */
+    std::vector<Aabb> lastBounds; /**< Collider box of every entity id on the step it was last seen */
+    std::vector<unsigned int> lastSeen; /**< Step in which every entity id last had a collider */
+    unsigned int step = 1; /**< Current step, starts past the zero of unseen ids */
+
+    /**
+     * @brief Collects the collider bounds of every entity, sorted by entity id.
+     */
+    void GatherProxies() {
+        auto entities = GetSystemEntities();
+        std::sort(entities.begin(), entities.end());
+        step++;
+
+        proxies.clear();
+        bounds.clear();
+        boxes.Clear();
+        for (auto entity : entities) {
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            const auto& transform = entity.GetComponent<TransformComponent>();
+
+            const std::string* tag = nullptr;
+            if (entity.HasComponent<PropertyComponent>()) {
+                tag = &entity.GetComponent<PropertyComponent>().tag;
+            }
+
+            glm::vec2 pos = transform.position + collider.offset;
+            float right = pos.x + static_cast<float>(collider.width);
+            float bottom = pos.y + static_cast<float>(collider.height);
+
+            // A script may move a platform or a wall with set_Position, and a
+            // new entity may take the id of a killed one
+            int id = entity.GetId();
+            if (id >= static_cast<int>(lastSeen.size())) {
+                lastSeen.resize(id + 1, 0);
+                lastBounds.resize(id + 1);
+            }
+            const Aabb& last = lastBounds[id];
+            bool hasMoved = lastSeen[id] != step - 1 || last.minX != pos.x || last.minY != pos.y
+                || last.maxX != right || last.maxY != bottom;
+            lastSeen[id] = step;
+            lastBounds[id] = { pos.x, pos.y, right, bottom };
+
+            bool isSleeping = false;
+            bool isStatic = !hasMoved;
+            if (entity.HasComponent<RigidBodyComponent>()) {
+                const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+                isSleeping = rigidbody.isSleeping;
+                isStatic = isStatic && !rigidbody.isDynamic && rigidbody.velocity == glm::vec2(0);
+            }
+
+            proxies.push_back({ entity, &collider, tag, isSleeping, isStatic });
+            bounds.push_back({ pos.x, pos.y, right, bottom });
+            boxes.Push(pos.x, pos.y, right, bottom);
+        }
+    }
+
+    /**
+     * @brief Runs the AABB test on every candidate pair across the JobPool.
+     *
+     * Pairs are sorted by (a, b), so each chunk walks runs of pairs sharing
+     * the same a and hands the run to the batched kernel, which tests a
+     * against 4 or 8 candidates at once. Pairs that are at rest are dropped
+     * before the kernel and tag exclusion is only checked on the hits.
+     * Each chunk writes to its own buffer; chunks cover contiguous ranges
+     * of pairs, so concatenating them in chunk order yields the same
+     * contact list as a single threaded run.
+     */
+    void FindContacts() {
+        JobPool& jobPool = JobPool::GetInstance();
+        int pairCount = static_cast<int>(pairs.size());
+        int chunkCount = jobPool.GetChunkCount(pairCount, NARROWPHASE_GRAIN);
+        if (static_cast<int>(chunkScratch.size()) < chunkCount) {
+            chunkScratch.resize(chunkCount);
+        }
+
+        jobPool.ParallelFor(pairCount, NARROWPHASE_GRAIN,
+            [this](int chunk, int begin, int end) {
+                ChunkScratch& scratch = chunkScratch[chunk];
+                scratch.contacts.clear();
+
+                int k = begin;
+                while (k < end) {
+                    int a = pairs[k].a;
+                    scratch.candidates.clear();
+                    while (k < end && pairs[k].a == a) {
+                        if (!IsRestingPair(proxies[a], proxies[pairs[k].b])) {
+                            scratch.candidates.push_back(pairs[k].b);
+                        }
+                        k++;
+                    }
+                    scratch.hits.resize(scratch.candidates.size());
+
+                    int hitCount = overlapKernel(boxes, a, scratch.candidates.data(),
+                        static_cast<int>(scratch.candidates.size()), scratch.hits.data());
+
+                    const BoxColliderComponent* collider = proxies[a].collider;
+                    for (int h = 0; h < hitCount; h++) {
+                        int b = scratch.hits[h];
+                        // Check for exclusion based on PropertyComponent
+                        if (proxies[b].tag && collider->IsExcluded(*proxies[b].tag)) {
+                            continue;
+                        }
+                        scratch.contacts.push_back({ a, b });
+                    }
+                }
+            });
+
+        contacts.clear();
+        for (int chunk = 0; chunk < chunkCount; chunk++) {
+            contacts.insert(contacts.end(), chunkScratch[chunk].contacts.begin(),
+                chunkScratch[chunk].contacts.end());
+        }
+    }
+
+    /**
+     * @brief Checks whether a pair can be skipped because nothing in it moves.
+     *
+     * A sleeping body against another sleeping body or against something
+     * that is not simulated and not moving cannot produce a new contact.
+     */
+    static bool IsRestingPair(const BoxProxy& a, const BoxProxy& b) {
+        return (a.isSleeping && (b.isSleeping || b.isStatic))
+            || (b.isSleeping && a.isStatic);
+    }
+
+    /**
+     * @brief Wakes the owner of a proxy if it is a sleeping rigid body.
+     */
+    void WakeProxy(int proxy) {
+        if (proxy >= 0 && proxies[proxy].isSleeping) {
+            proxies[proxy].entity.GetComponent<RigidBodyComponent>().WakeUp();
+        }
+    }
+
+    /**
+     * @brief Tells whether the carried contact between two proxies still holds.
+     */
+    bool IsStillTouching(int a, int b) const {
+        const Aabb& boxA = bounds[a];
+        const Aabb& boxB = bounds[b];
+        if (!(boxA.minX < boxB.maxX && boxA.maxX > boxB.minX
+            && boxA.minY < boxB.maxY && boxA.maxY > boxB.minY)) {
+            return false;
+        }
+        return !(proxies[b].tag && proxies[a].collider->IsExcluded(*proxies[b].tag));
+    }
+
     /**
-     * @brief Checks for AABB collision between two rectangles.
+     * @brief Keeps the previous contacts of the pairs the narrowphase skipped.
      *
-     * @param aX The x-position of the first rectangle.
-     * @param aY The y-position of the first rectangle.
-     * @param aw The width of the first rectangle.
-     * @param aH The height of the first rectangle.
-     * @param bX The x-position of the second rectangle.
-     * @param bY The y-position of the second rectangle.
-     * @param bw The width of the second rectangle.
-     * @param bH The height of the second rectangle.
-     * @return True if there is a collision; otherwise, false.
+     * A carried contact is checked with the same comparisons as the
+     * kernels, so it is dropped as soon as one of its boxes is gone or no
+     * longer overlaps the other. Previous contacts are in entity id order
+     * like the proxies, so the carried ones come out in pair order and are
+     * merged with the narrowphase contacts into the reported list.
      *
-     * This function checks if two rectangular bounding boxes intersect
-     * based on their positions and dimensions.
+     * A sleeping body whose previous contact is not carried lost its
+     * support, or was reached by something that moved, and is woken; the
+     * SleepSystem then wakes the rest of its island.
+     */
+    void CarryRestingContacts() {
+        restingContacts.clear();
+        for (const auto& contact : previousContacts) {
+            int a = FindProxy(contact.first);
+            int b = FindProxy(contact.second);
+            if (a >= 0 && b >= 0 && IsRestingPair(proxies[a], proxies[b]) && IsStillTouching(a, b)) {
+                restingContacts.push_back({ a, b });
+                continue;
+            }
+            WakeProxy(a);
+            WakeProxy(b);
+        }
+
+        reportedContacts.clear();
+        std::merge(contacts.begin(), contacts.end(), restingContacts.begin(), restingContacts.end(),
+            std::back_inserter(reportedContacts), [](const ProxyPair& l, const ProxyPair& r) {
+                return l.a < r.a || (l.a == r.a && l.b < r.b);
+            });
+    }
+
+    /**
+     * @brief Gets the proxy of an entity, -1 if it has no collider this step.
+     */
+    int FindProxy(const Entity& entity) const {
+        auto it = std::lower_bound(proxies.begin(), proxies.end(), entity,
+            [](const BoxProxy& proxy, const Entity& value) { return proxy.entity < value; });
+        if (it == proxies.end() || it->entity != entity) {
+            return -1;
+        }
+        return static_cast<int>(it - proxies.begin());
+    }
+
+    /**
+     * @brief Calls one contact callback of an entity's script with the other entity.
      */
-    bool CheckAABBCollision(float aX, float aY, float aw, float aH, float bX, float bY, float bw, float bH) {
-        return (
-            aX < bX + bw &&
-            aX + aw > bX &&
-            aY < bY + bH &&
-            aY + aH > bY
-            );
+    static void CallContactScript(sol::state& lua, Entity self, Entity other,
+        sol::function ScriptComponent::* callback, [[maybe_unused]] const char* profileName) {
+        if (!self.HasComponent<ScriptComponent>()) {
+            return;
+        }
+        const sol::function& function = self.GetComponent<ScriptComponent>().*callback;
+        if (function != sol::nil) {
+            PROFILE_SCOPE(profileName);
+            lua["this"] = self;
+            function(other);
+        }
+    }
+
+    /**
+     * @brief Runs on_collision for one side of a contact, or keeps it for on_collisions.
+     * @param self Proxy whose script is told.
+     * @param other Proxy it touches.
+     */
+    void DeliverContact(sol::state& lua, int self, int other) {
+        Entity entity = proxies[self].entity;
+        if (!entity.HasComponent<ScriptComponent>()) {
+            return;
+        }
+        const auto& script = entity.GetComponent<ScriptComponent>();
+        if (script.onCollisions != sol::nil) {
+            batchedContacts.push_back({ self, other });
+            return;
+        }
+        if (script.onCollision != sol::nil) {
+            PROFILE_SCOPE("Lua::on_collision");
+            lua["this"] = entity;
+            script.onCollision(proxies[other].entity);
+        }
+    }
+
+    /**
+     * @brief Calls on_collisions once per entity with the contacts kept by DeliverContact.
+     *
+     * Entities are called in id order and each list keeps the contact order.
+     * The list table belongs to the script component and is refilled on
+     * every call, so it is only valid during the call.
+     */
+    void DeliverBatchedContacts(sol::state& lua) {
+        // Proxies are sorted by entity id; a stable sort keeps the contact order per entity
+        std::stable_sort(batchedContacts.begin(), batchedContacts.end(),
+            [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; });
+
+        size_t run = 0;
+        while (run < batchedContacts.size()) {
+            int self = batchedContacts[run].first;
+            size_t runEnd = run;
+            while (runEnd < batchedContacts.size() && batchedContacts[runEnd].first == self) {
+                runEnd++;
+            }
+
+            Entity entity = proxies[self].entity;
+            auto& script = entity.GetComponent<ScriptComponent>();
+            int count = static_cast<int>(runEnd - run);
+            if (!script.collisionList.valid()) {
+                script.collisionList = lua.create_table(count, 0);
+            }
+            for (int i = 0; i < count; i++) {
+                script.collisionList[i + 1] = proxies[batchedContacts[run + i].second].entity;
+            }
+            // Entries left from a longer previous list would change its length
+            for (int i = count; i < script.collisionListSize; i++) {
+                script.collisionList[i + 1] = sol::lua_nil;
+            }
+            script.collisionListSize = count;
+
+            {
+                PROFILE_SCOPE("Lua::on_collisions");
+                lua["this"] = entity;
+                script.onCollisions(script.collisionList);
+            }
+            run = runEnd;
+        }
+        batchedContacts.clear();
+    }
+
+    /**
+     * @brief Tells whether a proxy's entity still has its collider.
+     *
+     * Queries read the proxies of the last Detect; a script may have killed
+     * the entity or removed its collider since, and killing clears every
+     * component at once.
+     */
+    bool IsLive(int proxy) const {
+        return proxies[proxy].entity.HasComponent<BoxColliderComponent>();
+    }
+
+    /**
+     * @brief Squared distance from a point to a proxy's box, 0 when inside.
+     */
+    float DistanceSquared(int proxy, const glm::vec2& point) const {
+        const Aabb& box = bounds[proxy];
+        float dx = std::max(std::max(box.minX - point.x, 0.0f), point.x - box.maxX);
+        float dy = std::max(std::max(box.minY - point.y, 0.0f), point.y - box.maxY);
+        return dx * dx + dy * dy;
+    }
+
+    /**
+     * @brief Slab test of a segment against a proxy's box.
+     * @param t Output segment parameter in [0, 1] where the box is entered, 0 if it starts inside.
+     */
+    bool SegmentHit(int proxy, const glm::vec2& from, const glm::vec2& delta, float& t) const {
+        const Aabb& box = bounds[proxy];
+        float tMin = 0.0f;
+        float tMax = 1.0f;
+        const float mins[2] = { box.minX, box.minY };
+        const float maxs[2] = { box.maxX, box.maxY };
+        for (int axis = 0; axis < 2; axis++) {
+            if (delta[axis] == 0.0f) {
+                if (from[axis] < mins[axis] || from[axis] > maxs[axis]) {
+                    return false;
+                }
+                continue;
+            }
+            float t1 = (mins[axis] - from[axis]) / delta[axis];
+            float t2 = (maxs[axis] - from[axis]) / delta[axis];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+            if (tMin > tMax) {
+                return false;
+            }
+        }
+        t = tMin;
+        return true;
     }
 
 public:
@@ -58,80 +419,218 @@ public:
      * @brief Constructs a BoxCollisionSystem.
      *
      * This constructor specifies that entities using this system must have
-     * BoxColliderComponent and TransformComponent.
+     * BoxColliderComponent and TransformComponent, and picks the overlap
+     * kernel for the running CPU.
      */
-    BoxCollisionSystem() {
+    BoxCollisionSystem() : overlapKernel(CollisionKernels::GetBoxKernel()) {
         RequireComponent<BoxColliderComponent>();
         RequireComponent<TransformComponent>();
     }
 
     /**
-     * @brief Updates collision status and triggers collision scripts for entities.
+     * @brief Finds the contacts of the current frame.
      *
+     * Runs the broadphase and the narrowphase; the contacts are kept until
+     * the next call so the OverlapSystem, the SleepSystem and the spatial
+     * queries can read them. The resting contacts of the previous step are
+     * carried over for the scripts.
+     */
+    void Detect() {
+        PROFILE_SCOPE("BoxCollisionSystem::Detect");
+        // Proxies are rebuilt below, keep the previous contacts by entity
+        previousContacts.clear();
+        for (const auto& contact : reportedContacts) {
+            previousContacts.push_back({ proxies[contact.a].entity, proxies[contact.b].entity });
+        }
+
+        GatherProxies();
+        broadphase.Build(bounds);
+        broadphase.FindPairs(pairs);
+        FindContacts();
+        CarryRestingContacts();
+    }
+
+    /**
+     * @brief Triggers collision events and scripts for the detected contacts.
+     *
+     * @param eventManager The event manager receiving the begin and end CollisionEvents.
      * @param lua The Lua state, used for executing Lua scripts.
      *
-     * This function iterates over all entities in the system, checks for collisions
-     * between their box colliders, and triggers onCollision Lua scripts if a collision
-     * occurs. Each entitys onCollision script is executed if present.
+     * On the calling thread, for each contact found by the last Detect, the
+     * on_collision script of both entities runs if present; entities whose
+     * script defines on_collisions instead get a single call after every
+     * contact was seen, with the array of entities they touch. Contacts that
+     * were not touching on the previous step also queue a Begin event and run
+     * on_collision_enter. Pairs that stopped touching queue an End event and
+     * run on_collision_exit on the entities that still have a collider.
+     * Contacts carried over because nothing in them moves are told like the
+     * others.
      */
-    void Update(const std::unique_ptr<EventManager>& eventManager, sol::state& lua) {
-        auto entities = GetSystemEntities();
+    void DispatchContacts(const std::unique_ptr<EventManager>& eventManager, sol::state& lua) {
+        PROFILE_SCOPE("BoxCollisionSystem::DispatchContacts");
+        bool hasHandlers = eventManager->HasHandlers<CollisionEvent>();
+        pairCache.BeginStep();
+        for (const auto& contact : reportedContacts) {
+            Entity a = proxies[contact.a].entity;
+            Entity b = proxies[contact.b].entity;
 
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            Entity a = *i;
-            const auto& aCollider = a.GetComponent<BoxColliderComponent>();
-            const auto& aTransform = a.GetComponent<TransformComponent>();
+            if (pairCache.Touch(a, b)) {
+                if (hasHandlers) {
+                    eventManager->QueueEvent<CollisionEvent>(a, b, ContactPhase::Begin);
+                }
+                CallContactScript(lua, a, b, &ScriptComponent::onCollisionEnter, "Lua::on_collision_enter");
+                CallContactScript(lua, b, a, &ScriptComponent::onCollisionEnter, "Lua::on_collision_enter");
+            }
 
-            glm::vec2 aPos = aTransform.position + aCollider.offset;
+            DeliverContact(lua, contact.a, contact.b);
+            DeliverContact(lua, contact.b, contact.a);
+        }
+        DeliverBatchedContacts(lua);
 
-            for (auto j = i; j != entities.end(); j++) {
-                Entity b = *j;
+        pairCache.CollectEnded(endedPairs);
 
-                if (a == b) continue;
+        for (const auto& pair : endedPairs) {
+            if (hasHandlers) {
+                eventManager->QueueEvent<CollisionEvent>(pair.first, pair.second, ContactPhase::End);
+            }
+            // Entities without a collider may have been killed, only the survivor is told
+            if (FindProxy(pair.first) >= 0) {
+                CallContactScript(lua, pair.first, pair.second,
+                    &ScriptComponent::onCollisionExit, "Lua::on_collision_exit");
+            }
+            if (FindProxy(pair.second) >= 0) {
+                CallContactScript(lua, pair.second, pair.first,
+                    &ScriptComponent::onCollisionExit, "Lua::on_collision_exit");
+            }
+        }
+    }
 
-                const auto& bCollider = b.GetComponent<BoxColliderComponent>();
-                const auto& bTransform = b.GetComponent<TransformComponent>();
+    /**
+     * @brief Forgets the touching pairs without ending them, used when the scene is unloaded.
+     */
+    void ClearPairCache() {
+        pairCache.Clear();
+        reportedContacts.clear();
+    }
 
-                glm::vec2 bPos = bTransform.position + bCollider.offset;
+    /**
+     * @brief Gets the entity pairs of every contact tested by the last Detect.
+     *
+     * Resting contacts carried over from the previous step are left out:
+     * nothing in them moves, so they need no response.
+     *
+     * @param result Output vector in contact order, cleared before use.
+     */
+    void GetContactEntities(std::vector<std::pair<Entity, Entity>>& result) const {
+        result.clear();
+        for (const auto& contact : contacts) {
+            result.push_back({ proxies[contact.a].entity, proxies[contact.b].entity });
+        }
+    }
 
-                // Check for exclusion based on PropertyComponent
-                if (b.HasComponent<PropertyComponent>()) {
-                    const auto& bProperty = b.GetComponent<PropertyComponent>();
-                    if (aCollider.IsExcluded(bProperty.tag)) {
-                        continue; // Skip processing collision for excluded tags
-                    }
-                }
+    /**
+     * @brief Gets every entity whose box collider overlaps a rectangle.
+     *
+     * Spatial queries use the broadphase built by the last Detect, so
+     * entities created since then are not found yet; entities killed since
+     * then are left out.
+     *
+     * @param area Rectangle in world coordinates.
+     * @param result Output vector in entity id order, cleared before use.
+     */
+    void QueryRect(const Aabb& area, std::vector<Entity>& result) {
+        result.clear();
+        broadphase.Query(area, queryCandidates);
+        for (int proxy : queryCandidates) {
+            const Aabb& box = bounds[proxy];
+            if (box.minX < area.maxX && box.maxX > area.minX
+                && box.minY < area.maxY && box.maxY > area.minY && IsLive(proxy)) {
+                result.push_back(proxies[proxy].entity);
+            }
+        }
+    }
 
-                bool collision = CheckAABBCollision(
-                    aPos.x, aPos.y,
-                    static_cast<float>(aCollider.width), static_cast<float>(aCollider.height),
-                    bPos.x, bPos.y,
-                    static_cast<float>(bCollider.width), static_cast<float>(bCollider.height)
-                );
-
-                if (collision) {
-                    eventManager->EmitEvent<CollisionEvent>(a, b);
-
-                    // Trigger onCollision script for entity a
-                    if (a.HasComponent<ScriptComponent>()) {
-                        const auto& script = a.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = a;
-                            script.onCollision(b);
-                        }
-                    }
+    /**
+     * @brief Gets every entity whose box collider touches a circle.
+     *
+     * @param center Circle center in world coordinates.
+     * @param radius Circle radius.
+     * @param result Output vector in entity id order, cleared before use.
+     */
+    void QueryRadius(const glm::vec2& center, float radius, std::vector<Entity>& result) {
+        result.clear();
+        Aabb area = { center.x - radius, center.y - radius, center.x + radius, center.y + radius };
+        broadphase.Query(area, queryCandidates);
+        for (int proxy : queryCandidates) {
+            if (DistanceSquared(proxy, center) <= radius * radius && IsLive(proxy)) {
+                result.push_back(proxies[proxy].entity);
+            }
+        }
+    }
 
-                    // Trigger onCollision script for entity b
-                    if (b.HasComponent<ScriptComponent>()) {
-                        const auto& script = b.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = b;
-                            script.onCollision(a);
-                        }
-                    }
-                }
+    /**
+     * @brief Gets every entity whose box collider is crossed by a segment.
+     *
+     * @param from Start of the segment.
+     * @param to End of the segment.
+     * @param result Output vector sorted by distance from the start, cleared before use.
+     */
+    void Raycast(const glm::vec2& from, const glm::vec2& to, std::vector<Entity>& result) {
+        result.clear();
+        queryHits.clear();
+        glm::vec2 delta = to - from;
+        broadphase.QuerySegment(from.x, from.y, to.x, to.y, queryCandidates);
+        for (int proxy : queryCandidates) {
+            float t;
+            if (SegmentHit(proxy, from, delta, t) && IsLive(proxy)) {
+                queryHits.push_back({ t, proxy });
+            }
+        }
+
+        // Ties keep entity id order
+        std::sort(queryHits.begin(), queryHits.end());
+        for (const auto& hit : queryHits) {
+            result.push_back(proxies[hit.second].entity);
+        }
+    }
+
+    /**
+     * @brief Finds the closest entity with a given tag within a radius.
+     *
+     * Distance is measured from the point to the entity's box collider.
+     *
+     * @param center Point to search from.
+     * @param radius Search radius.
+     * @param tag Tag of the PropertyComponent to match.
+     * @param nearest Output entity, only written when one is found.
+     * @return True if an entity was found.
+     */
+    bool NearestWithTag(const glm::vec2& center, float radius, const std::string& tag,
+        Entity& nearest) {
+        Aabb area = { center.x - radius, center.y - radius, center.x + radius, center.y + radius };
+        broadphase.Query(area, queryCandidates);
+
+        int best = -1;
+        float bestDistance = radius * radius;
+        for (int proxy : queryCandidates) {
+            Entity entity = proxies[proxy].entity;
+            // Read the tag now, it may have changed since the last Detect
+            if (!IsLive(proxy) || !entity.HasComponent<PropertyComponent>()
+                || entity.GetComponent<PropertyComponent>().tag != tag) {
+                continue;
+            }
+            float distance = DistanceSquared(proxy, center);
+            if (distance < bestDistance || (distance == bestDistance && best < 0)) {
+                best = proxy;
+                bestDistance = distance;
             }
         }
+
+        if (best < 0) {
+            return false;
+        }
+        nearest = proxies[best].entity;
+        return true;
     }
 };
 
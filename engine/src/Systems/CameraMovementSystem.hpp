@@ -12,9 +12,11 @@
 #include <SDL2/SDL.h>
 
 #include "../Components/CameraFollowComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
 #include "../Game/Game.hpp"
+#include "../Profiler/Profiler.hpp"
 
  /**
   * @brief Represents the system that manages camera movement based on entity positions.
@@ -39,17 +41,22 @@ public:
      * @brief Updates the camera position based on the entities it follows.
      *
      * @param camera A reference to the SDL_Rect representing the camera's viewport.
+     * @param alpha Position of the frame between the last two simulation steps.
      *
      * This function adjusts the camera's position based on the positions of entities
      * with the TransformComponent. It ensures the camera stays within the bounds of the game map.
+     * Rigid bodies are followed at the same interpolated position the RenderSystem draws them.
      */
-    void Update(SDL_Rect& camera) {
+    void Update(SDL_Rect& camera, float alpha = 1.0f) {
+        PROFILE_SCOPE("CameraMovementSystem::Update");
         for (auto entity : GetSystemEntities()) {
             const auto& transform = entity.GetComponent<TransformComponent>();
+            glm::vec2 position = entity.HasComponent<RigidBodyComponent>()
+                ? transform.GetInterpolatedPosition(alpha) : transform.position;
 
             // Center the camera on the entity's new position
-            camera.x = static_cast<int>(transform.position.x) - (camera.w / 2);
-            camera.y = static_cast<int>(transform.position.y) - (camera.h / 2);
+            camera.x = static_cast<int>(position.x) - (camera.w / 2);
+            camera.y = static_cast<int>(position.y) - (camera.h / 2);
 
             // Clamp camera position to prevent it from going out of bounds
             camera.x = std::max(0, std::min(camera.x, Game::GetInstance().mapWidth - camera.w));
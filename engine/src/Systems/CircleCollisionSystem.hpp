@@ -9,7 +9,10 @@
 #ifndef CIRCLECOLLISIONSYSTEM_HPP
 #define CIRCLECOLLISIONSYSTEM_HPP
 
+#include <algorithm>
+#include <cstdlib>
 #include <memory>
+#include <vector>
 #include <sol/sol.hpp>
 #include "../Components/CircleColliderComponent.hpp"
 #include "../Components/ScriptComponent.hpp"
@@ -17,22 +20,122 @@
 #include "../ECS/ECS.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../Events/CollisionEvent.hpp"
+#include "../Physics/BroadphaseGrid.hpp"
+#include "../Physics/CollisionKernels.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/JobPool.hpp"
 
  /**
   * @brief Represents the system that manages collision detection and response between entities.
   *
   * The CollisionSystem checks for circular collisions between entities with CircleColliderComponent
-  * and triggers collision events if necessary.
+  * and triggers collision events if necessary. Candidate pairs come from a
+  * uniform grid broadphase and are tested in parallel in batches per
+  * collider; scripts run afterwards on the calling thread in entity id order.
   */
 class CircleCollisionSystem : public System {
+private:
+    /** @brief Minimum number of candidate pairs handed to one worker */
+    static const int NARROWPHASE_GRAIN = 256;
+
+    /** @brief Buffers owned by one narrowphase chunk */
+    struct ChunkScratch {
+        std::vector<int> candidates; /**< Candidates of the circle being tested */
+        std::vector<int> hits; /**< Kernel output */
+        std::vector<ProxyPair> contacts; /**< Contacts found by the chunk */
+    };
+
+    BroadphaseGrid broadphase; /**< Candidate pair source */
+    CircleBatchKernel overlapKernel; /**< Batched circle test */
+    std::vector<Entity> proxies; /**< Owners of the circles, sorted by entity id */
+    std::vector<Aabb> bounds; /**< Bounds of every circle */
+    CircleBoundsSoA circles; /**< Centers and radii laid out for the batched kernels */
+    std::vector<ProxyPair> pairs; /**< Candidate pairs from the broadphase */
+    std::vector<ChunkScratch> chunkScratch; /**< Per-chunk narrowphase buffers */
+    std::vector<ProxyPair> contacts; /**< Merged contacts of the current frame */
+
+    /**
+     * @brief Collects center and radius of every entity, sorted by entity id.
+     */
+    void GatherProxies() {
+        auto entities = GetSystemEntities();
+        std::sort(entities.begin(), entities.end());
+
+        proxies.clear();
+        bounds.clear();
+        circles.Clear();
+        for (auto entity : entities) {
+            const auto& collider = entity.GetComponent<CircleColliderComponent>();
+            const auto& transform = entity.GetComponent<TransformComponent>();
+
+            glm::vec2 center = glm::vec2(
+                transform.position.x - (collider.width / 2) * transform.scale.x,
+                transform.position.y - (collider.height / 2) * transform.scale.y
+            );
+            int radius = collider.radius * transform.scale.x;
+
+            proxies.push_back(entity);
+            circles.Push(center.x, center.y, radius);
+            float extent = static_cast<float>(std::abs(radius));
+            bounds.push_back({ center.x - extent, center.y - extent,
+                center.x + extent, center.y + extent });
+        }
+    }
+
+    /**
+     * @brief Runs the circle test on every candidate pair across the JobPool.
+     *
+     * Runs of pairs sharing the same first circle go through the batched
+     * kernel together. Per-chunk buffers are concatenated in chunk order,
+     * which keeps the contact list identical to a single threaded run.
+     */
+    void FindContacts() {
+        JobPool& jobPool = JobPool::GetInstance();
+        int pairCount = static_cast<int>(pairs.size());
+        int chunkCount = jobPool.GetChunkCount(pairCount, NARROWPHASE_GRAIN);
+        if (static_cast<int>(chunkScratch.size()) < chunkCount) {
+            chunkScratch.resize(chunkCount);
+        }
+
+        jobPool.ParallelFor(pairCount, NARROWPHASE_GRAIN,
+            [this](int chunk, int begin, int end) {
+                ChunkScratch& scratch = chunkScratch[chunk];
+                scratch.contacts.clear();
+
+                int k = begin;
+                while (k < end) {
+                    int a = pairs[k].a;
+                    scratch.candidates.clear();
+                    while (k < end && pairs[k].a == a) {
+                        scratch.candidates.push_back(pairs[k].b);
+                        k++;
+                    }
+                    scratch.hits.resize(scratch.candidates.size());
+
+                    int hitCount = overlapKernel(circles, a, scratch.candidates.data(),
+                        static_cast<int>(scratch.candidates.size()), scratch.hits.data());
+                    for (int h = 0; h < hitCount; h++) {
+                        scratch.contacts.push_back({ a, scratch.hits[h] });
+                    }
+                }
+            });
+
+        contacts.clear();
+        for (int chunk = 0; chunk < chunkCount; chunk++) {
+            contacts.insert(contacts.end(), chunkScratch[chunk].contacts.begin(),
+                chunkScratch[chunk].contacts.end());
+        }
+    }
+
 public:
     /**
      * @brief Constructs a CollisionSystem.
      *
      * This constructor specifies that entities using this system must have
-     * CircleColliderComponent and TransformComponent.
+     * CircleColliderComponent and TransformComponent, and picks the overlap
+     * kernel for the running CPU.
      */
-    CircleCollisionSystem() {
+    CircleCollisionSystem() : overlapKernel(CollisionKernels::GetCircleKernel()) {
         RequireComponent<CircleColliderComponent>();
         RequireComponent<TransformComponent>();
     }
@@ -42,80 +145,42 @@ public:
      *
      * @param lua A reference to the Lua state used for scripting.
      *
-     * This function iterates through all entities in the system, checking for circular
-     * collisions between pairs of entities. If a collision is detected, it triggers
-     * the onCollision scripts associated with the entities involved.
+     * This function finds every pair of colliding circles and then, on the
+     * calling thread, triggers the onCollision scripts associated with the
+     * entities involved.
      */
     void Update(sol::state& lua) {
-        auto entities = GetSystemEntities();
-
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            Entity a = *i;
-            auto aCollider = a.GetComponent<CircleColliderComponent>();
-            auto aTransform = a.GetComponent<TransformComponent>();
-
-            for (auto j = i; j != entities.end(); j++) {
-                Entity b = *j;
-
-                if (a == b) {
-                    continue; // Skip self-collision
+        PROFILE_SCOPE("CircleCollisionSystem::Update");
+        GatherProxies();
+        broadphase.Build(bounds);
+        broadphase.FindPairs(pairs);
+        FindContacts();
+
+        for (const auto& contact : contacts) {
+            Entity a = proxies[contact.a];
+            Entity b = proxies[contact.b];
+
+            // Trigger onCollision script for entity a
+            if (a.HasComponent<ScriptComponent>()) {
+                const auto& script = a.GetComponent<ScriptComponent>();
+                if (script.onCollision != sol::nil) {
+                    PROFILE_SCOPE("Lua::on_collision");
+                    lua["this"] = a;
+                    script.onCollision(b);
                 }
+            }
 
-                auto bCollider = b.GetComponent<CircleColliderComponent>();
-                auto bTransform = b.GetComponent<TransformComponent>();
-
-                glm::vec2 aCenterPos = glm::vec2(
-                    aTransform.position.x - (aCollider.width / 2) * aTransform.scale.x,
-                    aTransform.position.y - (aCollider.height / 2) * aTransform.scale.y
-                );
-
-                glm::vec2 bCenterPos = glm::vec2(
-                    bTransform.position.x - (bCollider.width / 2) * bTransform.scale.x,
-                    bTransform.position.y - (bCollider.height / 2) * bTransform.scale.y
-                );
-
-                int aRadius = aCollider.radius * aTransform.scale.x;
-                int bRadius = bCollider.radius * bTransform.scale.x;
-
-                bool collision = CheckCircularCollision(aRadius, bRadius, aCenterPos, bCenterPos);
-
-                if (collision) {
-                    // Trigger onCollision script for entity a
-                    if (a.HasComponent<ScriptComponent>()) {
-                        const auto& script = a.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = a;
-                            script.onCollision(b);
-                        }
-                    }
-
-                    // Trigger onCollision script for entity b
-                    if (b.HasComponent<ScriptComponent>()) {
-                        const auto& script = b.GetComponent<ScriptComponent>();
-                        if (script.onCollision != sol::nil) {
-                            lua["this"] = b;
-                            script.onCollision(a);
-                        }
-                    }
+            // Trigger onCollision script for entity b
+            if (b.HasComponent<ScriptComponent>()) {
+                const auto& script = b.GetComponent<ScriptComponent>();
+                if (script.onCollision != sol::nil) {
+                    PROFILE_SCOPE("Lua::on_collision");
+                    lua["this"] = b;
+                    script.onCollision(a);
                 }
             }
         }
     }
-
-    /**
-     * @brief Checks for circular collision between two entities.
-     *
-     * @param aRadius The radius of the first entity's collider.
-     * @param bRadius The radius of the second entity's collider.
-     * @param aPos The position of the first entity's collider.
-     * @param bPos The position of the second entity's collider.
-     * @return true if a collision is detected, false otherwise.
-     */
-    bool CheckCircularCollision(int aRadius, int bRadius, glm::vec2 aPos, glm::vec2 bPos) {
-        glm::vec2 dif = aPos - bPos;
-        double length = glm::sqrt((dif.x * dif.x) + (dif.y * dif.y));
-        return (aRadius + bRadius) >= length;
-    }
 };
 
 #endif // CIRCLECOLLISIONSYSTEM_HPP
@@ -0,0 +1,265 @@
+/**
+ * @file ContinuousCollisionSystem.hpp
+ * @brief Defines the ContinuousCollisionSystem that stops fast bodies from tunneling through solids.
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup System
+ */
+
+#ifndef CONTINUOUSCOLLISIONSYSTEM_HPP
+#define CONTINUOUSCOLLISIONSYSTEM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Components/BoxColliderComponent.hpp"
+#include "../Components/PropertyComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
+#include "../Components/TransformComponent.hpp"
+#include "../ECS/ECS.hpp"
+#include "../Physics/BroadphaseGrid.hpp"
+#include "../Physics/TileCollisionGrid.hpp"
+#include "../Profiler/Profiler.hpp"
+
+ /**
+  * @brief Represents the system that sweeps fast moving boxes against static solids.
+  *
+  * Runs right after the MovementSystem. Every mover is swept from its
+  * previousPosition to its new position against the solid colliders that are
+  * not dynamic (map colliders, walls, platforms) and against the tile
+  * collision grid when the map uses one. When the sweep hits something
+  * the mover is moved back to the time of impact, left a hair inside the
+  * obstacle so the BoxCollisionSystem still reports the contact, and the
+  * OverlapSystem resolves it as usual.
+  *
+  * Movers are bodies flagged with isBullet, plus dynamic solid bodies that
+  * moved more than half their own size this frame.
+  */
+class ContinuousCollisionSystem : public System {
+private:
+    /** @brief Depth left inside the obstacle so the discrete pass detects the contact */
+    static constexpr float CONTACT_SKIN = 0.01f;
+
+    /** @brief Static solid gathered once per frame */
+    struct Obstacle {
+        Entity entity; /**< Owner of the collider */
+        const std::string* tag; /**< Tag of the owner or nullptr */
+    };
+
+    BroadphaseGrid obstacleGrid; /**< Grid over the obstacle bounds */
+    std::vector<Obstacle> obstacles; /**< Obstacles sorted by entity id */
+    std::vector<Aabb> obstacleBounds; /**< Bounds of every obstacle */
+    std::vector<int> candidates; /**< Query output for the current mover */
+    std::vector<TileSolid> tileCandidates; /**< Map solids near the current mover */
+
+    /**
+     * @brief Checks whether an entity has to be swept this frame.
+     */
+    bool IsMover(const RigidBodyComponent& rigidbody, const BoxColliderComponent& collider,
+        const glm::vec2& displacement) const {
+        if (rigidbody.isBullet) {
+            return displacement.x != 0.0f || displacement.y != 0.0f;
+        }
+        if (!rigidbody.isDynamic || !rigidbody.isSolid) {
+            return false;
+        }
+        return std::abs(displacement.x) > collider.width * 0.5f
+            || std::abs(displacement.y) > collider.height * 0.5f;
+    }
+
+    /**
+     * @brief Computes the time of impact of a moving box against a static box.
+     *
+     * @param box Bounds of the mover at the start of the frame.
+     * @param displacement Movement of the mover during the frame.
+     * @param target Bounds of the obstacle.
+     * @param toi Output time of impact in [0, 1].
+     * @param normal Output contact normal pointing out of the obstacle.
+     * @return True if the mover enters the obstacle during the frame.
+     *
+     * Boxes already overlapping at the start are ignored; the discrete
+     * collision pass handles them.
+     */
+    bool SweptAabb(const Aabb& box, const glm::vec2& displacement, const Aabb& target,
+        float& toi, glm::vec2& normal) const {
+        const float infinity = std::numeric_limits<float>::infinity();
+
+        float entryX, exitX, entryY, exitY;
+        if (displacement.x > 0.0f) {
+            entryX = (target.minX - box.maxX) / displacement.x;
+            exitX = (target.maxX - box.minX) / displacement.x;
+        }
+        else if (displacement.x < 0.0f) {
+            entryX = (target.maxX - box.minX) / displacement.x;
+            exitX = (target.minX - box.maxX) / displacement.x;
+        }
+        else {
+            if (box.maxX <= target.minX || box.minX >= target.maxX) {
+                return false;
+            }
+            entryX = -infinity;
+            exitX = infinity;
+        }
+
+        if (displacement.y > 0.0f) {
+            entryY = (target.minY - box.maxY) / displacement.y;
+            exitY = (target.maxY - box.minY) / displacement.y;
+        }
+        else if (displacement.y < 0.0f) {
+            entryY = (target.maxY - box.minY) / displacement.y;
+            exitY = (target.minY - box.maxY) / displacement.y;
+        }
+        else {
+            if (box.maxY <= target.minY || box.minY >= target.maxY) {
+                return false;
+            }
+            entryY = -infinity;
+            exitY = infinity;
+        }
+
+        float entry = std::max(entryX, entryY);
+        float exit = std::min(exitX, exitY);
+        if (entry >= exit || entry < 0.0f || entry > 1.0f) {
+            return false;
+        }
+
+        toi = entry;
+        if (entryX > entryY) {
+            normal = glm::vec2(displacement.x > 0.0f ? -1.0f : 1.0f, 0.0f);
+        }
+        else {
+            normal = glm::vec2(0.0f, displacement.y > 0.0f ? -1.0f : 1.0f);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Collects the bounds of every static solid, sorted by entity id.
+     */
+    void GatherObstacles(const std::vector<Entity>& entities) {
+        obstacles.clear();
+        obstacleBounds.clear();
+        for (auto entity : entities) {
+            const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            if (!rigidbody.isSolid || rigidbody.isDynamic || rigidbody.isBullet) {
+                continue;
+            }
+
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            const std::string* tag = nullptr;
+            if (entity.HasComponent<PropertyComponent>()) {
+                tag = &entity.GetComponent<PropertyComponent>().tag;
+            }
+
+            glm::vec2 pos = transform.position + collider.offset;
+            obstacles.push_back({ entity, tag });
+            obstacleBounds.push_back({ pos.x, pos.y,
+                pos.x + static_cast<float>(collider.width),
+                pos.y + static_cast<float>(collider.height) });
+        }
+        obstacleGrid.Build(obstacleBounds);
+    }
+
+public:
+    /**
+     * @brief Constructs a ContinuousCollisionSystem.
+     *
+     * This constructor specifies that entities using this system must have
+     * BoxColliderComponent, RigidBodyComponent and TransformComponent.
+     */
+    ContinuousCollisionSystem() {
+        RequireComponent<BoxColliderComponent>();
+        RequireComponent<RigidBodyComponent>();
+        RequireComponent<TransformComponent>();
+    }
+
+    /**
+     * @brief Sweeps every mover from its previous to its current position.
+     *
+     * Must run after the MovementSystem, which stores previousPosition.
+     * Each mover stops at its earliest impact; ties go to the obstacle with
+     * the lowest entity id, then to map solids.
+     *
+     * @param tiles Static map geometry, may be empty.
+     */
+    void Update(const TileCollisionGrid& tiles) {
+        PROFILE_SCOPE("ContinuousCollisionSystem::Update");
+        auto entities = GetSystemEntities();
+        std::sort(entities.begin(), entities.end());
+        GatherObstacles(entities);
+        if (obstacles.empty() && !tiles.IsEnabled()) {
+            return;
+        }
+
+        for (auto entity : entities) {
+            const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            auto& transform = entity.GetComponent<TransformComponent>();
+
+            glm::vec2 displacement = transform.position - transform.previousPosition;
+            if (!IsMover(rigidbody, collider, displacement)) {
+                continue;
+            }
+
+            glm::vec2 start = transform.previousPosition + collider.offset;
+            float width = static_cast<float>(collider.width);
+            float height = static_cast<float>(collider.height);
+            Aabb box = { start.x, start.y, start.x + width, start.y + height };
+            Aabb swept = {
+                box.minX + std::min(displacement.x, 0.0f),
+                box.minY + std::min(displacement.y, 0.0f),
+                box.maxX + std::max(displacement.x, 0.0f),
+                box.maxY + std::max(displacement.y, 0.0f)
+            };
+
+            float bestToi = 2.0f;
+            glm::vec2 bestNormal(0.0f);
+            obstacleGrid.Query(swept, candidates);
+            for (int index : candidates) {
+                const Obstacle& obstacle = obstacles[index];
+                if (obstacle.entity == entity) {
+                    continue;
+                }
+                if (obstacle.tag && collider.IsExcluded(*obstacle.tag)) {
+                    continue;
+                }
+
+                float toi;
+                glm::vec2 normal;
+                if (SweptAabb(box, displacement, obstacleBounds[index], toi, normal)
+                    && toi < bestToi) {
+                    bestToi = toi;
+                    bestNormal = normal;
+                }
+            }
+
+            tiles.QuerySolids(swept, tileCandidates);
+            for (const auto& solid : tileCandidates) {
+                if (solid.tag && collider.IsExcluded(*solid.tag)) {
+                    continue;
+                }
+
+                float toi;
+                glm::vec2 normal;
+                if (SweptAabb(box, displacement, solid.box, toi, normal) && toi < bestToi) {
+                    bestToi = toi;
+                    bestNormal = normal;
+                }
+            }
+
+            if (bestToi > 1.0f) {
+                continue;
+            }
+
+            // Stop at the impact, just inside the obstacle
+            transform.position = transform.previousPosition + displacement * bestToi
+                - bestNormal * CONTACT_SKIN;
+        }
+    }
+};
+
+#endif // CONTINUOUSCOLLISIONSYSTEM_HPP
@@ -14,6 +14,8 @@
 #include "../Components/BoxColliderComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
 
 /**
  * @brief A system responsible for displaying hitboxes in the game.
@@ -46,6 +48,7 @@ public:
      * @param camera The SDL_Rect representing the camera's position and dimensions.
      */
     void Update(SDL_Renderer* renderer, SDL_Rect& camera) {
+        PROFILE_SCOPE("HitboxShowSystem::Update");
         for (auto entity : GetSystemEntities()) {
             const auto& collider = entity.GetComponent<BoxColliderComponent>();
             const auto& transform = entity.GetComponent<TransformComponent>();
@@ -61,6 +64,7 @@ public:
 
             SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255);
             SDL_RenderDrawRect(renderer, &box);
+            RenderStats::CountDraw();
         }
     }
 
@@ -1,6 +1,6 @@
 /**
  * @file MovementSystem.hpp
- * @brief Defines the MovementSystem responsible for updating entity positions based on their velocities.
+ * @brief Defines the MovementSystem responsible for integrating forces, velocities and positions of entities.
  * @author Juan Torres
  * @date 2024
  * @ingroup System
@@ -14,14 +14,28 @@
 #include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
 
  /**
   * @brief Represents the system that manages the movement of entities.
   *
-  * The MovementSystem updates the position of entities based on their
-  * velocity as defined in the RigidBodyComponent.
+  * The MovementSystem applies gravity and the accumulated forces to dynamic
+  * bodies and moves every body by its velocity as defined in the
+  * RigidBodyComponent. Gravity, forces, velocity and position are
+  * integrated in one pass over the components, so every body is read and
+  * written once per step instead of once by a gravity pass and again here.
+  *
+  * The components own the body state and most systems and the Lua bindings
+  * read them directly, so the bodies are not copied into separate arrays:
+  * a copy and write back every step cost more than the integration itself.
+  * The movement_update and movement_two_pass cases of ecs_bench compare
+  * this pass with separate gravity and movement passes.
   */
 class MovementSystem : public System {
+private:
+    /** @brief Gravity in pixels per second squared, 9.8 m/s2 at 64 pixels per meter */
+    static constexpr float GRAVITY = 9.8f * 64.0f;
+
 public:
     /**
      * @brief Constructs a MovementSystem.
@@ -35,31 +49,36 @@ public:
     }
 
     /**
-     * @brief Updates the position of entities based on their velocity.
+     * @brief Integrates forces, velocity and position of every entity.
      *
      * @param dt The delta time since the last update.
      *
-     * This function iterates over all entities in the system and updates their
-     * positions according to their velocity and the elapsed time.
+     * Stores previousPosition for the collision systems. Dynamic bodies get
+     * gravity and their sumForces, which are cleared afterwards; the other
+     * bodies only move by their velocity. Sleeping bodies are left where
+     * they are.
      */
     void Update(double dt) {
+        PROFILE_SCOPE("MovementSystem::Update");
+        const float step = static_cast<float>(dt);
         for (auto entity : GetSystemEntities()) {
             auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
             auto& transform = entity.GetComponent<TransformComponent>();
 
             transform.previousPosition = transform.position;
 
+            if (rigidbody.isSleeping) {
+                continue;
+            }
+
             if (rigidbody.isDynamic) {
                 rigidbody.acceleration = rigidbody.sumForces * rigidbody.invMass;
-                rigidbody.velocity += rigidbody.acceleration * static_cast<float>(dt);
-                transform.position += rigidbody.velocity * static_cast<float>(dt);
+                rigidbody.acceleration.y += GRAVITY;
+                rigidbody.velocity += rigidbody.acceleration * step;
                 rigidbody.sumForces = glm::vec2(0);
             }
-            else {
-                // Update position based on velocity and delta time
-                transform.position.x += rigidbody.velocity.x * dt;
-                transform.position.y += rigidbody.velocity.y * dt;
-            }
+
+            transform.position += rigidbody.velocity * step;
         }
     }
 };
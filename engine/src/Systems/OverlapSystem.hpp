@@ -1,7 +1,7 @@
 /**
  * @file OverlapSystem.hpp
- * @brief Designed to check collisions between entities and handle the overlap behavior based 
- * on their positions and components.
+ * @brief Designed to resolve the overlap between solid entities reported by the
+ * collision pass, based on their positions and components.
  * @author Juan Torres
  * @date 2024
  * @ingroup System
@@ -10,150 +10,172 @@
 #ifndef OVERLAPSYSTEM_HPP
 #define OVERLAPSYSTEM_HPP
 
-#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "../Components/BoxColliderComponent.hpp"
+#include "../Components/PropertyComponent.hpp"
 #include "../Components/RigidBodyComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
-#include "../EventManager/EventManager.hpp"
-#include "../Events/CollisionEvent.hpp"
+#include "../Physics/ContactSolver.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "BoxCollisionSystem.hpp"
 
 /**
- * @brief Enum representing the four cardinal directions.
+ * @brief A system responsible for separating overlapping solid entities.
  *
- * This enum is used to specify directions for collision detection and movement logic.
- */
-enum Direction {
-    top,    /**< Represents the top direction. */
-    left,   /**< Represents the left direction. */
-    bottom, /**< Represents the bottom direction. */
-    right   /**< Represents the right direction. */
-};
-
-/**
- * @brief A system responsible for detecting and handling overlaps between entities.
+ * The `OverlapSystem` takes the contacts found by the BoxCollisionSystem,
+ * keeps those between two solid rigid bodies and hands them to a
+ * ContactSolver in a single batch. In every contact the heavier entity stays
+ * in place and the lighter one is pushed out; on equal mass the entity with
+ * the lower id stays. The pushed entity loses the velocity that drove it into
+ * the contact.
  *
- * The `OverlapSystem` is designed to check collisions between entities and handle
- * the overlap behavior based on their positions and components.
+ * A push can press a body into a neighbour it was only touching when the
+ * contacts were detected. After solving, the bodies that moved look for such
+ * neighbours through the collision broadphase and the new contacts are
+ * solved in the same frame.
  */
 class OverlapSystem : public System {
 private:
+    /** @brief Passes over the contact list per frame */
+    static const int SOLVER_ITERATIONS = 4;
+
+    /** @brief Times the moved bodies look for contacts created by the pushes */
+    static const int DISCOVERY_ROUNDS = 2;
+
+    ContactSolver solver; /**< Bodies and contacts of the current frame */
+    std::vector<Entity> solverEntities; /**< Entity of every solver body */
+    std::vector<int> bodyIndex; /**< Entity id to solver body, -1 if not added */
+    std::vector<std::pair<Entity, Entity>> contacts; /**< Contacts from the collision pass */
+    std::vector<uint64_t> pairKeys; /**< Sorted entity id pairs already in the solver */
+    std::vector<Entity> neighbours; /**< Query output for a moved body */
 
     /**
-     * @brief Checks if two entities collide in a specific direction.
-     *
-     * This method checks for collisions between two entities and determines if they overlap
-     * in a given direction. It uses the entities' position and collider components for the check.
-     *
-     * @param a The first entity to check for collision.
-     * @param b The second entity to check for collision.
-     * @param dir The direction in which to check for overlap.
-     * @return `true` if the entities overlap in the specified direction, `false` otherwise.
+     * @brief Checks whether an entity takes part in overlap resolution.
      */
-    bool CheckCollision(Entity a, Entity b, Direction dir) {
-        auto& aCollider = a.GetComponent<BoxColliderComponent>();
-        auto& bCollider = b.GetComponent<BoxColliderComponent>();
-        auto& aTransform = a.GetComponent<TransformComponent>();
-        auto& bTransform = b.GetComponent<TransformComponent>();
-
-        // Adjust for offset
-        glm::vec2 aPos = aTransform.previousPosition + aCollider.offset;
-        glm::vec2 bPos = bTransform.previousPosition + bCollider.offset;
-
-        float aX = aPos.x;
-        float aY = aPos.y;
-        float aW = static_cast<float>(aCollider.width);
-        float aH = static_cast<float>(aCollider.height);
-
-        float bX = bPos.x;
-        float bY = bPos.y;
-        float bW = static_cast<float>(bCollider.width);
-        float bH = static_cast<float>(bCollider.height);
-
-        // Top side of A colliding with bottom side of B
-        if (Direction::top == dir) {
-            return (
-                aX < bX + bW &&
-                aX + aW > bX &&
-                aY > bY
-                );
-        }
+    bool IsSolidBody(Entity entity) const {
+        return entity.HasComponent<BoxColliderComponent>()
+            && entity.HasComponent<RigidBodyComponent>()
+            && entity.GetComponent<RigidBodyComponent>().isSolid;
+    }
 
-        // Left side of A colliding with right side of B
-        if (Direction::left == dir) {
-            return (
-                aY < bY + bH &&
-                aY + aH > bY &&
-                aX > bX
-                );
+    /**
+     * @brief Gets the solver body of an entity, adding it on first use.
+     */
+    int GetBody(Entity entity) {
+        int id = entity.GetId();
+        if (id >= static_cast<int>(bodyIndex.size())) {
+            bodyIndex.resize(id + 1, -1);
         }
-
-        // Bottom side of A colliding with top side of B
-        if (Direction::bottom == dir) {
-            return (
-                aX < bX + bW &&
-                aX + aW > bX &&
-                aY < bY
-                );
+        if (bodyIndex[id] >= 0) {
+            return bodyIndex[id];
         }
 
-        // Right side of A colliding with left side of B
-        if (Direction::right == dir) {
-            return (
-                aY < bY + bH &&
-                aY + aH > bY &&
-                aX < bX
-                );
-        }
+        const auto& collider = entity.GetComponent<BoxColliderComponent>();
+        const auto& transform = entity.GetComponent<TransformComponent>();
+        float width = static_cast<float>(collider.width);
+        float height = static_cast<float>(collider.height);
+        glm::vec2 pos = transform.position + collider.offset;
+        glm::vec2 prev = transform.previousPosition + collider.offset;
+
+        bodyIndex[id] = solver.AddBody({ pos.x, pos.y, pos.x + width, pos.y + height },
+            { prev.x, prev.y, prev.x + width, prev.y + height });
+        solverEntities.push_back(entity);
+        return bodyIndex[id];
+    }
 
-        return false;
+    /**
+     * @brief Packs the entity ids of a pair, lower id first.
+     */
+    static uint64_t PairKey(Entity a, Entity b) {
+        uint64_t low = static_cast<uint32_t>(std::min(a.GetId(), b.GetId()));
+        uint64_t high = static_cast<uint32_t>(std::max(a.GetId(), b.GetId()));
+        return (low << 32) | high;
     }
 
     /**
-     * @brief Resolves overlap between two entities.
-     *
-     * This method handles the logic to prevent or resolve overlap between two entities by adjusting
-     * their positions or other necessary actions. It is typically used to prevent entities from
-     * intersecting when they should not.
-     *
-     * @param a The first entity involved in the potential overlap.
-     * @param b The second entity involved in the potential overlap.
+     * @brief Adds the contact between two solid bodies, the heavier one stays.
+     * @param a Entity with the lower id, kept in place on equal mass.
+     * @param b Entity with the higher id.
      */
-    void AvoidOverlap(Entity a, Entity b) {
-        auto& aCollider = a.GetComponent<BoxColliderComponent>();
-        auto& aTransform = a.GetComponent<TransformComponent>();
-
-        auto& bCollider = b.GetComponent<BoxColliderComponent>();
-        auto& bTransform = b.GetComponent<TransformComponent>();
-        auto& bRigidbody = b.GetComponent<RigidBodyComponent>();
-
-        // Adjust for offset
-        glm::vec2 aPos = aTransform.position + aCollider.offset;
-        // glm::vec2 bPos = bTransform.position + bCollider.offset;
-
-        if (CheckCollision(a, b, Direction::top)) {
-            // Move entity B upwards
-            bTransform.position.y = aPos.y - bCollider.height - bCollider.offset.y;
-            bRigidbody.velocity.y = 0.0f;
+    void AddContact(Entity a, Entity b) {
+        int bodyA = GetBody(a);
+        int bodyB = GetBody(b);
+        if (a.GetComponent<RigidBodyComponent>().mass >= b.GetComponent<RigidBodyComponent>().mass) {
+            solver.AddContact(bodyA, bodyB);
+        }
+        else {
+            solver.AddContact(bodyB, bodyA);
         }
+    }
 
-        if (CheckCollision(a, b, Direction::bottom)) {
-            // Move entity B downwards
-            bTransform.position.y = aPos.y + aCollider.height - bCollider.offset.y;
-            bRigidbody.velocity.y = 0.0f;
+    /**
+     * @brief Adds the contacts the last solve created between moved bodies and their neighbours.
+     * @return True if any contact was added.
+     */
+    bool FindNewContacts(BoxCollisionSystem& boxCollision) {
+        size_t knownCount = pairKeys.size();
+        int bodyCount = solver.GetBodyCount();
+        for (int body = 0; body < bodyCount; body++) {
+            if (!solver.GetBlocked(body)) {
+                continue;
+            }
+            Entity entity = solverEntities[body];
+            boxCollision.QueryRect(solver.GetBox(body), neighbours);
+            for (auto neighbour : neighbours) {
+                if (neighbour == entity || !IsSolidBody(neighbour)) {
+                    continue;
+                }
+                uint64_t key = PairKey(entity, neighbour);
+                if (std::binary_search(pairKeys.begin(), pairKeys.begin() + knownCount, key)
+                    || std::find(pairKeys.begin() + knownCount, pairKeys.end(), key) != pairKeys.end()) {
+                    continue;
+                }
+
+                // Same exclusion rule as the narrowphase
+                Entity a = entity < neighbour ? entity : neighbour;
+                Entity b = entity < neighbour ? neighbour : entity;
+                if (b.HasComponent<PropertyComponent>()
+                    && a.GetComponent<BoxColliderComponent>().IsExcluded(b.GetComponent<PropertyComponent>().tag)) {
+                    continue;
+                }
+                pairKeys.push_back(key);
+                AddContact(a, b);
+            }
         }
 
-        if (CheckCollision(a, b, Direction::left)) {
-            // Move entity B to the left
-            bTransform.position.x = aPos.x - bCollider.width - bCollider.offset.x;
-            bRigidbody.velocity.x = 0.0f;
+        if (pairKeys.size() == knownCount) {
+            return false;
         }
+        std::sort(pairKeys.begin(), pairKeys.end());
+        return true;
+    }
+
+    /**
+     * @brief Writes the solved positions back and stops the pushed bodies.
+     */
+    void ApplyResults() {
+        for (int body = 0; body < solver.GetBodyCount(); body++) {
+            Entity entity = solverEntities[body];
+            bodyIndex[entity.GetId()] = -1;
+
+            uint8_t blocked = solver.GetBlocked(body);
+            if (!blocked) {
+                continue;
+            }
 
-        if (CheckCollision(a, b, Direction::right)) {
-            // Move entity B to the right
-            bTransform.position.x = aPos.x + aCollider.width - bCollider.offset.x;
-            bRigidbody.velocity.x = 0.0f;
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            auto& transform = entity.GetComponent<TransformComponent>();
+            auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            const Aabb& box = solver.GetBox(body);
+            transform.position.x = box.minX - collider.offset.x;
+            transform.position.y = box.minY - collider.offset.y;
+            ContactSolver::StopBlockedVelocity(blocked, rigidbody.velocity.x, rigidbody.velocity.y);
         }
     }
 
@@ -171,40 +193,39 @@ public:
     }
 
     /**
-     * @brief Subscribes to collision events.
+     * @brief Resolves every solid contact found by the collision pass.
      *
-     * This method subscribes the `OverlapSystem` to listen for collision events. When a collision event
-     * occurs, the system will respond by processing the entities involved in the collision.
+     * @param boxCollision Collision system holding this frame's contacts.
      *
-     * @param eventManager A reference to the event manager used to subscribe to the collision events.
+     * Must run after the BoxCollisionSystem has detected the contacts and
+     * before they are dispatched, so scripts see the resolved positions.
      */
-    void SubscribeToCollisionEvent(
-        const std::unique_ptr<EventManager>& eventManager) {
-        eventManager->SubscribeToEvent<CollisionEvent, OverlapSystem>(this,
-            &OverlapSystem::OnCollisionEvent);
-    }
+    void Update(BoxCollisionSystem& boxCollision) {
+        PROFILE_SCOPE("OverlapSystem::Update");
+        boxCollision.GetContactEntities(contacts);
+
+        solver.Clear();
+        solverEntities.clear();
+        pairKeys.clear();
+        for (const auto& contact : contacts) {
+            if (!IsSolidBody(contact.first) || !IsSolidBody(contact.second)) {
+                continue;
+            }
+            // Contacts come in entity id order
+            pairKeys.push_back(PairKey(contact.first, contact.second));
+            AddContact(contact.first, contact.second);
+        }
 
-    /**
-     * @brief Handles a collision event.
-     *
-     * This method processes a `CollisionEvent` and resolves the collision between the involved entities.
-     * It checks the necessary conditions and applies appropriate responses such as adjusting entity positions
-     * or triggering event-based reactions.
-     *
-     * @param e The collision event containing the information about the collision.
-     */
-    void OnCollisionEvent(CollisionEvent& e) {
-        auto& aRigidbody = e.a.GetComponent<RigidBodyComponent>();
-        auto& bRigidbody = e.b.GetComponent<RigidBodyComponent>();
+        if (solver.GetContactCount() == 0) {
+            return;
+        }
+        std::sort(pairKeys.begin(), pairKeys.end());
 
-        if (aRigidbody.isSolid && bRigidbody.isSolid) {
-            if (aRigidbody.mass >= bRigidbody.mass) {
-                AvoidOverlap(e.a, e.b);
-            }
-            else {
-                AvoidOverlap(e.b, e.a);
-            }
+        solver.Solve(SOLVER_ITERATIONS);
+        for (int round = 0; round < DISCOVERY_ROUNDS && FindNewContacts(boxCollision); round++) {
+            solver.Solve(SOLVER_ITERATIONS);
         }
+        ApplyResults();
     }
 };
 
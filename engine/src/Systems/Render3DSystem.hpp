@@ -32,6 +32,8 @@
 #include "../AssetManager/AssetManager.hpp"
 #include "../Components/ObjectComponent.hpp"
 #include "../Components/TransformComponent.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
 
  /**
   * @brief Represents the system that handles 3D Rendering.
@@ -97,6 +99,7 @@ public:
      */
  void linesDrawing(SDL_Renderer* renderer, const glm::vec3& start, const glm::vec3& end)   
     {
+        RenderStats::CountDraw();
         SDL_RenderDrawLine(renderer, static_cast<int>(start.x), static_cast<int>(start.y),
             static_cast<int>(end.x), static_cast<int>(end.y));
     }
@@ -222,6 +225,7 @@ public:
             points[1] = { static_cast<int>(face.v2.x + offsetX), static_cast<int>(face.v2.y + offsetY) };
             points[2] = { static_cast<int>(face.v3.x + offsetX), static_cast<int>(face.v3.y + offsetY) };
 
+            RenderStats::CountDraw();
             filledTrigonRGBA(renderer,
                 points[0].x, points[0].y,
                 points[1].x, points[1].y,
@@ -332,6 +336,7 @@ public:
      * @param assetManager A unique pointer to the asset manager that manages the game's assets.
      */
     void Update(SDL_Renderer* renderer, const std::unique_ptr<AssetManager>& assetManager) {
+        PROFILE_SCOPE("Render3DSystem::Update");
         for (auto entity : GetSystemEntities()) {
             const auto objectComponent = entity.GetComponent<ObjectComponent>();
             const auto transformComponent = entity.GetComponent<TransformComponent>();
@@ -357,6 +362,7 @@ public:
      * @param assetManager A unique pointer to the asset manager that manages the game's assets.
      */
     void UpdateWireframe(SDL_Renderer* renderer, const std::unique_ptr<AssetManager>& assetManager) {
+        PROFILE_SCOPE("Render3DSystem::UpdateWireframe");
         for (auto entity : GetSystemEntities()) {
             const auto objectComponent = entity.GetComponent<ObjectComponent>();
             const auto transformComponent = entity.GetComponent<TransformComponent>();
@@ -10,19 +10,139 @@
 #define RENDERSYSTEM_HPP
 
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "../AssetManager/AssetManager.hpp"
+#include "../AssetManager/Tilemap.hpp"
+#include "../Components/RigidBodyComponent.hpp"
+#include "../Components/ScriptComponent.hpp"
 #include "../Components/SpriteComponent.hpp"
+#include "../Components/TileLayerComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/SpriteBatch.hpp"
+#include "../Utils/SpriteCullingGrid.hpp"
 
  /**
   * @brief Represents the system that manages the rendering of entities.
   *
   * The RenderSystem updates the display of entities based on their
   * position, scale, rotation, and sprite information.
+  * Consecutive sprites sharing a texture are drawn with one
+  * SDL_RenderGeometry call through a SpriteBatch, so a tile layer costs one
+  * draw call while the draw order stays the order of the entities. Sprite
+  * source rectangles are relative to their image and are moved to the
+  * image's place in its atlas page here, so scripts and animations never
+  * see atlas coordinates.
+  *
+  * Sprites without a rigid body or a script, such as map tiles, are taken
+  * as static and kept in a SpriteCullingGrid, so only the ones near the
+  * camera are visited. The grid is rebuilt when the entity list of the
+  * system changes. The Lua bindings that move, turn or resize a sprite
+  * call MarkMoved, which takes it out of the grid for good. The other
+  * sprites are tested against the screen one by one.
   */
 class RenderSystem : public System {
+private:
+    /** @brief Pixels around the screen in which sprites are still drawn */
+    static constexpr int CULL_MARGIN = 64;
+
+    SpriteBatch batch; /**< Quads of the current run of sprites */
+    SpriteCullingGrid staticSprites; /**< Bounds of the static sprites */
+    std::vector<Entity> drawList; /**< Entities in draw order when the grid was built */
+    std::vector<int> movingSprites; /**< Positions in drawList of the sprites tested every frame */
+    std::vector<int> visible; /**< Positions in drawList drawn this frame */
+    std::vector<uint8_t> isMarkedMoved; /**< Entity ids moved by scripts, never taken as static */
+    unsigned int cullingVersion = 0; /**< Entity version the grid was built for */
+    bool isCullingBuilt = false; /**< False until the first build */
+
+    /**
+     * @brief Gets the screen area a sprite covers, rotation included.
+     */
+    static Aabb GetScreenBounds(const SDL_Rect& dstRect, double rotation) {
+        if (rotation == 0.0) {
+            return { static_cast<float>(std::min(dstRect.x, dstRect.x + dstRect.w)),
+                static_cast<float>(std::min(dstRect.y, dstRect.y + dstRect.h)),
+                static_cast<float>(std::max(dstRect.x, dstRect.x + dstRect.w)),
+                static_cast<float>(std::max(dstRect.y, dstRect.y + dstRect.h)) };
+        }
+        // Any rotation stays inside the circle through the corners
+        float centerX = dstRect.x + dstRect.w * 0.5f;
+        float centerY = dstRect.y + dstRect.h * 0.5f;
+        float radius = 0.5f * std::sqrt(static_cast<float>(dstRect.w) * dstRect.w
+            + static_cast<float>(dstRect.h) * dstRect.h);
+        return { centerX - radius, centerY - radius, centerX + radius, centerY + radius };
+    }
+
+    /**
+     * @brief Gets the rectangle a sprite is drawn to, before the camera offset.
+     */
+    static SDL_Rect GetWorldRect(const SpriteComponent& sprite, const TransformComponent& transform,
+        const glm::vec2& position) {
+        return {
+            static_cast<int>(position.x),
+            static_cast<int>(position.y),
+            static_cast<int>(sprite.width * transform.scale.x),
+            static_cast<int>(sprite.height * transform.scale.y)
+        };
+    }
+
+    /**
+     * @brief Shrinks a destination like its source was clipped, as SDL_RenderCopyEx does.
+     * @param fullRect Source before clipping.
+     * @param srcRect Source after clipping, inside fullRect.
+     * @param flip True if the sprite is mirrored, the cut then lands on the other side.
+     * @param dstRect Destination of fullRect, changed to the destination of srcRect.
+     */
+    static void ClipDestination(const SDL_Rect& fullRect, const SDL_Rect& srcRect, bool flip,
+        SDL_Rect& dstRect) {
+        float scaleX = static_cast<float>(dstRect.w) / fullRect.w;
+        float scaleY = static_cast<float>(dstRect.h) / fullRect.h;
+        int cutLeft = flip ? (fullRect.x + fullRect.w) - (srcRect.x + srcRect.w) : srcRect.x - fullRect.x;
+        int cutTop = srcRect.y - fullRect.y;
+        dstRect.x += static_cast<int>(std::lround(cutLeft * scaleX));
+        dstRect.y += static_cast<int>(std::lround(cutTop * scaleY));
+        dstRect.w = static_cast<int>(std::lround(srcRect.w * scaleX));
+        dstRect.h = static_cast<int>(std::lround(srcRect.h * scaleY));
+    }
+
+    /**
+     * @brief Tells whether an entity id was passed to MarkMoved.
+     */
+    bool IsMarkedMoved(int id) const {
+        return id < static_cast<int>(isMarkedMoved.size()) && isMarkedMoved[id] != 0;
+    }
+
+    /**
+     * @brief Sorts the sprites into static and moving ones and rebuilds the grid.
+     */
+    void RebuildCulling() {
+        PROFILE_SCOPE("RenderSystem::RebuildCulling");
+        drawList = GetSystemEntities();
+        movingSprites.clear();
+        staticSprites.Clear();
+        for (size_t i = 0; i < drawList.size(); i++) {
+            Entity entity = drawList[i];
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            if (transform.cameraFree || entity.HasComponent<TileLayerComponent>()
+                || entity.HasComponent<RigidBodyComponent>()
+                || entity.HasComponent<ScriptComponent>() || IsMarkedMoved(entity.GetId())) {
+                movingSprites.push_back(static_cast<int>(i));
+                continue;
+            }
+            const auto& sprite = entity.GetComponent<SpriteComponent>();
+            SDL_Rect worldRect = GetWorldRect(sprite, transform, transform.position);
+            staticSprites.Add(GetScreenBounds(worldRect, transform.rotation), static_cast<int>(i));
+        }
+        staticSprites.Build();
+        cullingVersion = GetEntityVersion();
+        isCullingBuilt = true;
+    }
+
 public:
     /**
      * @brief Constructs a RenderSystem.
@@ -35,51 +155,131 @@ public:
         RequireComponent<TransformComponent>();
     }
 
+    /**
+     * @brief Tests a sprite against the screen every frame from now on.
+     *
+     * Called when a script changes the position, rotation or size of an
+     * entity. A sprite that was in the static grid makes the grid be
+     * rebuilt once; an id reused by a later entity stays marked, which only
+     * costs that entity its culling shortcut.
+     *
+     * @param entity The entity that changed.
+     */
+    void MarkMoved(Entity entity) {
+        int id = entity.GetId();
+        if (IsMarkedMoved(id)) {
+            return;
+        }
+        if (id >= static_cast<int>(isMarkedMoved.size())) {
+            isMarkedMoved.resize(id + 1, 0);
+        }
+        isMarkedMoved[id] = 1;
+        isCullingBuilt = false;
+    }
+
+    /**
+     * @brief Forgets the sprites passed to MarkMoved, used when the scene is cleared.
+     */
+    void ClearMarks() {
+        isMarkedMoved.clear();
+        isCullingBuilt = false;
+    }
+
     /**
      * @brief Renders entities to the screen.
      *
      * @param renderer Pointer to the SDL_Renderer used for rendering.
      * @param camera The camera's viewport for rendering adjustments.
      * @param AssetManager A unique pointer to the AssetManager for retrieving textures.
+     * @param tilemap Tilemap drawing the baked layers at their entity's place.
+     * @param alpha Position of the frame between the last two simulation steps.
      *
      * This function iterates over all entities in the system and renders their
      * sprites to the screen, adjusting for camera position and entity transformation.
+     * Rigid bodies are drawn between their previous and current position so
+     * movement stays smooth when the simulation runs slower than the display.
+     * The texture is only looked up when the texture id changes from the
+     * previous sprite, and the lookup is not kept across frames since assets
+     * may be reloaded between them. Sprites further than CULL_MARGIN from
+     * the screen are skipped; static ones are not visited at all.
      */
     void Update(SDL_Renderer* renderer, SDL_Rect& camera,
-        const std::unique_ptr<AssetManager>& AssetManager) {
-        for (auto entity : GetSystemEntities()) {
-            const auto sprite = entity.GetComponent<SpriteComponent>();
-            const auto transform = entity.GetComponent<TransformComponent>();
+        const std::unique_ptr<AssetManager>& AssetManager, Tilemap& tilemap, float alpha = 1.0f) {
+        PROFILE_SCOPE("RenderSystem::Update");
+        if (!isCullingBuilt || GetEntityVersion() != cullingVersion) {
+            RebuildCulling();
+        }
+
+        // Static sprites near the camera, then every moving one, back in draw order
+        const Aabb screen = {
+            static_cast<float>(-CULL_MARGIN),
+            static_cast<float>(-CULL_MARGIN),
+            static_cast<float>(camera.w + CULL_MARGIN),
+            static_cast<float>(camera.h + CULL_MARGIN)
+        };
+        const Aabb view = {
+            screen.minX + camera.x,
+            screen.minY + camera.y,
+            screen.maxX + camera.x,
+            screen.maxY + camera.y
+        };
+        visible.clear();
+        staticSprites.Query(view, visible);
+        visible.insert(visible.end(), movingSprites.begin(), movingSprites.end());
+        std::sort(visible.begin(), visible.end());
 
-            SDL_Rect srcRect = sprite.srcRect;
+        tilemap.BeginFrame();
+        batch.Reset();
+        const std::string* textureId = nullptr;
+        const AssetManager::TextureRegion* region = nullptr;
+        for (int index : visible) {
+            Entity entity = drawList[index];
+            if (entity.HasComponent<TileLayerComponent>()) {
+                batch.Flush(renderer);
+                tilemap.RenderLayer(renderer, camera, AssetManager,
+                    entity.GetComponent<TileLayerComponent>().layer);
+                continue;
+            }
+
+            const auto& sprite = entity.GetComponent<SpriteComponent>();
+            const auto& transform = entity.GetComponent<TransformComponent>();
 
-            int dstX = static_cast<int>(transform.position.x);
-            int dstY = static_cast<int>(transform.position.y);
+            glm::vec2 position = entity.HasComponent<RigidBodyComponent>()
+                ? transform.GetInterpolatedPosition(alpha) : transform.position;
+            SDL_Rect dstRect = GetWorldRect(sprite, transform, position);
 
             // Adjust for camera position if not camera-free
             if (!transform.cameraFree) {
-                dstX -= camera.x;
-                dstY -= camera.y;
+                dstRect.x -= camera.x;
+                dstRect.y -= camera.y;
+            }
+
+            Aabb bounds = GetScreenBounds(dstRect, transform.rotation);
+            if (bounds.maxX < screen.minX || bounds.minX > screen.maxX
+                || bounds.maxY < screen.minY || bounds.minY > screen.maxY) {
+                continue;
+            }
+
+            if (textureId == nullptr || sprite.textureId != *textureId) {
+                region = &AssetManager->GetTextureRegion(sprite.textureId);
+                textureId = &sprite.textureId;
+            }
+
+            // Keep the source inside the image, neighbours share the page
+            SDL_Rect fullRect = sprite.srcRect;
+            fullRect.x += region->rect.x;
+            fullRect.y += region->rect.y;
+            SDL_Rect srcRect;
+            if (!SDL_IntersectRect(&fullRect, &region->rect, &srcRect)) {
+                continue;
+            }
+            if (srcRect.w != fullRect.w || srcRect.h != fullRect.h) {
+                ClipDestination(fullRect, srcRect, sprite.flip, dstRect);
             }
 
-            SDL_Rect dstRect = {
-                dstX,
-                dstY,
-                static_cast<int>(sprite.width * transform.scale.x),
-                static_cast<int>(sprite.height * transform.scale.y)
-            };
-
-            // Render the sprite with rotation
-            SDL_RenderCopyEx(
-                renderer,
-                AssetManager->GetTexture(sprite.textureId),
-                &srcRect,
-                &dstRect,
-                transform.rotation,
-                NULL,
-                (sprite.flip) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE
-            );
+            batch.Draw(renderer, region->texture, srcRect, dstRect, transform.rotation, sprite.flip);
         }
+        batch.Flush(renderer);
     }
 };
 
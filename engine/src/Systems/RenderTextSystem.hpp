@@ -18,6 +18,8 @@
 #include "../Components/TextComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
 
  /**
   * @brief Represents the system that manages the rendering of text entities.
@@ -49,6 +51,7 @@ public:
      */
     void Update(SDL_Renderer* renderer,
         const std::unique_ptr<AssetManager>& assetManager) {
+        PROFILE_SCOPE("RenderTextSystem::Update");
         for (auto entity : GetSystemEntities()) {
             auto& text = entity.GetComponent<TextComponent>();
             auto& transform = entity.GetComponent<TransformComponent>();
@@ -62,6 +65,7 @@ public:
             // Create a texture from the surface
             SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
             SDL_FreeSurface(surface);
+            RenderStats::CountUpload();
 
             // Define the destination rectangle for rendering
             SDL_Rect dstRect = {
@@ -73,6 +77,7 @@ public:
 
             // Render the text texture to the screen
             SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+            RenderStats::CountDraw();
             SDL_DestroyTexture(texture);
         }
     }
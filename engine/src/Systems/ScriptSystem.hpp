@@ -15,6 +15,7 @@
 #include "../Binding/LuaBinding.hpp"
 #include "../Components/ScriptComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
 
  /**
   * @brief Represents the system that manages Lua scripting for entities.
@@ -70,6 +71,10 @@ public:
         lua.set_function("get_Data", GetEntityData);
         lua.set_function("delete_Entity", DeleteEntity);
         lua.set_function("get_time", GetTime);
+        lua.set_function("set_target_fps", SetTargetFps);
+        lua.set_function("set_vsync", SetVsync);
+        lua.set_function("get_frame_stats", GetFrameStats);
+        lua.set_function("write_trace", WriteTrace);
         lua.set_function("left_collision", LeftCollision);
         lua.set_function("right_collision", RightCollision);
         lua.set_function("set_rigid", SetRigid);
@@ -83,6 +88,12 @@ public:
         lua.set_function("set_solid", SetSolid);
         lua.set_function("get_solid", GetSolid);
         lua.set_function("set_shadow", SetShadow);
+        lua.set_function("query_rect", QueryRect);
+        lua.set_function("query_radius", QueryRadius);
+        lua.set_function("raycast", Raycast);
+        lua.set_function("nearest_with_tag", NearestWithTag);
+        lua.set_function("set_tile", SetTile);
+        lua.set_function("get_tile", GetTile);
     }
 
     /**
@@ -94,10 +105,12 @@ public:
      * executes their associated update function if defined.
      */
     void Update(sol::state& lua) {
+        PROFILE_SCOPE("ScriptSystem::Update");
         for (auto entity : GetSystemEntities()) {
             const auto& script = entity.GetComponent<ScriptComponent>();
 
             if (script.update != sol::lua_nil) {
+                PROFILE_SCOPE("Lua::update");
                 lua["this"] = entity;
                 script.update();
             }
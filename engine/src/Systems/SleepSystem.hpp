@@ -0,0 +1,271 @@
+/**
+ * @file SleepSystem.hpp
+ * @brief Defines the SleepSystem that puts resting groups of rigid bodies to sleep.
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup System
+ */
+
+#ifndef SLEEPSYSTEM_HPP
+#define SLEEPSYSTEM_HPP
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Components/RigidBodyComponent.hpp"
+#include "../Components/TransformComponent.hpp"
+#include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "BoxCollisionSystem.hpp"
+
+ /**
+  * @brief Represents the system that decides which dynamic bodies sleep.
+  *
+  * Dynamic bodies touching each other form an island. When every body of an
+  * island has stayed below the sleep speed for SLEEP_DELAY seconds the whole
+  * island falls asleep: gravity, integration and narrowphase skip it. The
+  * island is remembered so that waking any of its bodies, by a contact with
+  * an awake body, by the loss of a contact, or by a script calling
+  * add_force, set_velocity, set_Position or set_rigid, wakes all of them on
+  * the same frame. Killing or moving the ground under a sleeping island
+  * therefore wakes it.
+  */
+class SleepSystem : public System {
+private:
+    /** @brief Speed in pixels per second under which a body counts as resting */
+    static constexpr float SLEEP_SPEED = 10.0f;
+
+    /** @brief Seconds an island must rest before it falls asleep */
+    static constexpr float SLEEP_DELAY = 0.5f;
+
+    std::vector<Entity> bodies; /**< Dynamic bodies of the current frame, sorted by id */
+    std::vector<int> bodyIndex; /**< Entity id to index in bodies, -1 if not a body */
+    std::vector<int> parent; /**< Union-find parent of every body */
+    std::vector<std::pair<Entity, Entity>> contacts; /**< Contacts from the collision pass */
+    std::vector<int> islandStart; /**< Offset of every root's island in islandBodies, plus the end */
+    std::vector<int> islandBodies; /**< Awake bodies grouped by island root */
+    std::vector<Entity> sleepingMembers; /**< Members of every sleeping island, island after island */
+    std::vector<int> sleepingEnds; /**< End of every sleeping island in sleepingMembers */
+
+    /**
+     * @brief Finds the root of a body's island, compressing the path.
+     */
+    int Find(int body) {
+        while (parent[body] != body) {
+            parent[body] = parent[parent[body]];
+            body = parent[body];
+        }
+        return body;
+    }
+
+    /**
+     * @brief Merges the islands of two bodies, the lower index becomes the root.
+     */
+    void Union(int a, int b) {
+        a = Find(a);
+        b = Find(b);
+        if (a == b) {
+            return;
+        }
+        if (a < b) {
+            parent[b] = a;
+        }
+        else {
+            parent[a] = b;
+        }
+    }
+
+    /**
+     * @brief Gets the index of an entity in bodies, or -1.
+     */
+    int IndexOf(Entity entity) const {
+        int id = entity.GetId();
+        return id < static_cast<int>(bodyIndex.size()) ? bodyIndex[id] : -1;
+    }
+
+    /**
+     * @brief Wakes every body of the sleeping islands that had a member woken.
+     *
+     * Bodies are woken individually by contacts and Lua bindings; this
+     * spreads the wake up to the rest of their island.
+     */
+    void WakeTouchedIslands() {
+        // Islands still asleep are packed towards the front in place
+        size_t kept = 0;
+        size_t keptIslands = 0;
+        int begin = 0;
+        for (int end : sleepingEnds) {
+            bool isTouched = false;
+            for (int i = begin; i < end; i++) {
+                Entity member = sleepingMembers[i];
+                if (!member.HasComponent<RigidBodyComponent>()
+                    || !member.GetComponent<RigidBodyComponent>().isSleeping) {
+                    isTouched = true;
+                    break;
+                }
+            }
+
+            if (isTouched) {
+                for (int i = begin; i < end; i++) {
+                    Entity member = sleepingMembers[i];
+                    if (member.HasComponent<RigidBodyComponent>()) {
+                        member.GetComponent<RigidBodyComponent>().WakeUp();
+                    }
+                }
+            }
+            else {
+                for (int i = begin; i < end; i++) {
+                    sleepingMembers[kept++] = sleepingMembers[i];
+                }
+                sleepingEnds[keptIslands++] = static_cast<int>(kept);
+            }
+            begin = end;
+        }
+        sleepingMembers.erase(sleepingMembers.begin() + kept, sleepingMembers.end());
+        sleepingEnds.resize(keptIslands);
+    }
+
+public:
+    /**
+     * @brief Constructs a SleepSystem.
+     *
+     * This constructor specifies that entities using this system must have
+     * RigidBodyComponent and TransformComponent.
+     */
+    SleepSystem() {
+        RequireComponent<RigidBodyComponent>();
+        RequireComponent<TransformComponent>();
+    }
+
+    /**
+     * @brief Builds the contact islands and updates the sleep state of every body.
+     *
+     * @param boxCollision Collision system holding this frame's contacts.
+     * @param dt The delta time since the last update.
+     *
+     * Must run after the collision response so the velocities it reads are
+     * the ones left by the OverlapSystem.
+     */
+    void Update(const BoxCollisionSystem& boxCollision, double dt) {
+        PROFILE_SCOPE("SleepSystem::Update");
+        boxCollision.GetContactEntities(contacts);
+
+        bodies.clear();
+        for (auto entity : GetSystemEntities()) {
+            if (entity.GetComponent<RigidBodyComponent>().isDynamic) {
+                bodies.push_back(entity);
+            }
+        }
+        std::sort(bodies.begin(), bodies.end());
+
+        int maxId = bodies.empty() ? -1 : bodies.back().GetId();
+        bodyIndex.assign(maxId + 1, -1);
+        parent.resize(bodies.size());
+        for (size_t i = 0; i < bodies.size(); i++) {
+            bodyIndex[bodies[i].GetId()] = static_cast<int>(i);
+            parent[i] = static_cast<int>(i);
+        }
+
+        // The collision pass drops pairs at rest, so any contact that still
+        // involves a sleeping body means something touched it
+        for (const auto& contact : contacts) {
+            int a = IndexOf(contact.first);
+            int b = IndexOf(contact.second);
+            if (a >= 0) {
+                auto& rigidbody = bodies[a].GetComponent<RigidBodyComponent>();
+                if (rigidbody.isSleeping) {
+                    rigidbody.WakeUp();
+                }
+            }
+            if (b >= 0) {
+                auto& rigidbody = bodies[b].GetComponent<RigidBodyComponent>();
+                if (rigidbody.isSleeping) {
+                    rigidbody.WakeUp();
+                }
+            }
+            if (a >= 0 && b >= 0) {
+                Union(a, b);
+            }
+        }
+        WakeTouchedIslands();
+
+        // Rest timers of the awake bodies
+        float step = static_cast<float>(dt);
+        float sleepSpeedSquared = SLEEP_SPEED * SLEEP_SPEED;
+        for (auto entity : bodies) {
+            auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            if (rigidbody.isSleeping) {
+                continue;
+            }
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            glm::vec2 moved = transform.position - transform.previousPosition;
+            float movedLimit = SLEEP_SPEED * step;
+
+            bool isResting = glm::dot(rigidbody.velocity, rigidbody.velocity) < sleepSpeedSquared
+                && glm::dot(moved, moved) <= movedLimit * movedLimit;
+            rigidbody.sleepTimer = isResting ? rigidbody.sleepTimer + step : 0.0f;
+        }
+
+        // Group the awake bodies by island root: count, then place with the running offsets
+        islandStart.assign(bodies.size() + 1, 0);
+        for (size_t i = 0; i < bodies.size(); i++) {
+            if (!bodies[i].GetComponent<RigidBodyComponent>().isSleeping) {
+                islandStart[Find(static_cast<int>(i)) + 1]++;
+            }
+        }
+        for (size_t root = 1; root < islandStart.size(); root++) {
+            islandStart[root] += islandStart[root - 1];
+        }
+        islandBodies.resize(islandStart.back());
+        for (size_t i = 0; i < bodies.size(); i++) {
+            if (!bodies[i].GetComponent<RigidBodyComponent>().isSleeping) {
+                islandBodies[islandStart[Find(static_cast<int>(i))]++] = static_cast<int>(i);
+            }
+        }
+        // The placement moved every offset to the start of the next island
+        for (size_t root = islandStart.size() - 1; root > 0; root--) {
+            islandStart[root] = islandStart[root - 1];
+        }
+        islandStart[0] = 0;
+
+        // An island sleeps when its most recently active body has rested long enough
+        for (size_t root = 0; root < bodies.size(); root++) {
+            int begin = islandStart[root];
+            int end = islandStart[root + 1];
+            if (begin == end) {
+                continue;
+            }
+            bool canSleep = true;
+            for (int i = begin; i < end; i++) {
+                if (bodies[islandBodies[i]].GetComponent<RigidBodyComponent>().sleepTimer < SLEEP_DELAY) {
+                    canSleep = false;
+                    break;
+                }
+            }
+            if (!canSleep) {
+                continue;
+            }
+
+            for (int i = begin; i < end; i++) {
+                Entity member = bodies[islandBodies[i]];
+                auto& rigidbody = member.GetComponent<RigidBodyComponent>();
+                rigidbody.isSleeping = true;
+                rigidbody.velocity = glm::vec2(0);
+                rigidbody.sumForces = glm::vec2(0);
+                sleepingMembers.push_back(member);
+            }
+            sleepingEnds.push_back(static_cast<int>(sleepingMembers.size()));
+        }
+    }
+
+    /**
+     * @brief Forgets every sleeping island, used when the scene is cleared.
+     */
+    void Clear() {
+        sleepingMembers.clear();
+        sleepingEnds.clear();
+    }
+};
+
+#endif // SLEEPSYSTEM_HPP
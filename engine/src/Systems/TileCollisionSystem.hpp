@@ -0,0 +1,170 @@
+/**
+ * @file TileCollisionSystem.hpp
+ * @brief Defines the TileCollisionSystem that keeps bodies out of the static map geometry.
+ * @author Juan Torres
+ * @date 2024
+ * @ingroup System
+ */
+
+#ifndef TILECOLLISIONSYSTEM_HPP
+#define TILECOLLISIONSYSTEM_HPP
+
+#include <SDL2/SDL.h>
+#include <vector>
+#include <glm/glm.hpp>
+#include "../Components/BoxColliderComponent.hpp"
+#include "../Components/RigidBodyComponent.hpp"
+#include "../Components/TransformComponent.hpp"
+#include "../ECS/ECS.hpp"
+#include "../Physics/ContactSolver.hpp"
+#include "../Physics/TileCollisionGrid.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
+
+ /**
+  * @brief Represents the system that resolves bodies against the tile collision grid.
+  *
+  * Owns the TileCollisionGrid filled by the SceneLoader when a map sets
+  * tile_collision = true. Solid bodies that moved this frame only look at
+  * the map cells they overlap. Every solid they touch goes to a
+  * ContactSolver as a body that stays in place, so bodies are pushed out
+  * and stopped by the same code the OverlapSystem uses between entities.
+  * Map solids are not entities, so they never reach the collision systems
+  * or Lua scripts.
+  */
+class TileCollisionSystem : public System {
+private:
+    /** @brief Passes over the contact list per frame */
+    static const int SOLVER_ITERATIONS = 4;
+
+    TileCollisionGrid grid; /**< Static map geometry */
+    std::vector<TileSolid> solids; /**< Query output for the current body */
+    ContactSolver solver; /**< Moving bodies and the solids they touch */
+    std::vector<Entity> solverEntities; /**< Entity of every moving body */
+    std::vector<int> solverBodies; /**< Solver body of every entry in solverEntities */
+
+    /**
+     * @brief Computes the world bounds of a collider with its entity at a position.
+     */
+    static Aabb GetBounds(const BoxColliderComponent& collider, const glm::vec2& position) {
+        glm::vec2 pos = position + collider.offset;
+        return { pos.x, pos.y,
+            pos.x + static_cast<float>(collider.width),
+            pos.y + static_cast<float>(collider.height) };
+    }
+
+public:
+    /**
+     * @brief Constructs a TileCollisionSystem.
+     *
+     * This constructor specifies that entities using this system must have
+     * BoxColliderComponent, RigidBodyComponent and TransformComponent.
+     */
+    TileCollisionSystem() {
+        RequireComponent<BoxColliderComponent>();
+        RequireComponent<RigidBodyComponent>();
+        RequireComponent<TransformComponent>();
+    }
+
+    /**
+     * @brief Gets the grid so the SceneLoader can fill it and other systems query it.
+     */
+    TileCollisionGrid& GetGrid() {
+        return grid;
+    }
+
+    /**
+     * @brief Resolves every moving solid body against the map.
+     *
+     * Must run after the MovementSystem and the ContinuousCollisionSystem,
+     * and before the BoxCollisionSystem.
+     */
+    void Update() {
+        PROFILE_SCOPE("TileCollisionSystem::Update");
+        if (!grid.IsEnabled()) {
+            return;
+        }
+
+        solver.Clear();
+        solverEntities.clear();
+        solverBodies.clear();
+        for (auto entity : GetSystemEntities()) {
+            const auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            if (!rigidbody.isSolid || rigidbody.isSleeping) {
+                continue;
+            }
+            if (!rigidbody.isDynamic && transform.position == transform.previousPosition) {
+                continue;
+            }
+
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            Aabb box = GetBounds(collider, transform.position);
+            grid.QuerySolids(box, solids);
+            int body = -1;
+            for (const auto& solid : solids) {
+                if (solid.tag && collider.IsExcluded(*solid.tag)) {
+                    continue;
+                }
+                if (body < 0) {
+                    body = solver.AddBody(box, GetBounds(collider, transform.previousPosition));
+                    solverEntities.push_back(entity);
+                    solverBodies.push_back(body);
+                }
+                // Map solids never move, so their previous bounds are their bounds
+                solver.AddContact(solver.AddBody(solid.box, solid.box), body);
+            }
+        }
+
+        if (solver.GetContactCount() == 0) {
+            return;
+        }
+        solver.Solve(SOLVER_ITERATIONS);
+
+        for (size_t i = 0; i < solverEntities.size(); i++) {
+            uint8_t blocked = solver.GetBlocked(solverBodies[i]);
+            if (!blocked) {
+                continue;
+            }
+            Entity entity = solverEntities[i];
+            const auto& collider = entity.GetComponent<BoxColliderComponent>();
+            auto& transform = entity.GetComponent<TransformComponent>();
+            auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
+            const Aabb& box = solver.GetBox(solverBodies[i]);
+            transform.position.x = box.minX - collider.offset.x;
+            transform.position.y = box.minY - collider.offset.y;
+            ContactSolver::StopBlockedVelocity(blocked, rigidbody.velocity.x, rigidbody.velocity.y);
+        }
+    }
+
+    /**
+     * @brief Draws the outline of every map solid near the camera.
+     *
+     * @param renderer Pointer to the SDL renderer used for drawing.
+     * @param camera The SDL_Rect representing the camera's position and dimensions.
+     */
+    void RenderDebug(SDL_Renderer* renderer, SDL_Rect& camera) {
+        PROFILE_SCOPE("TileCollisionSystem::RenderDebug");
+        if (!grid.IsEnabled()) {
+            return;
+        }
+
+        Aabb view = { static_cast<float>(camera.x), static_cast<float>(camera.y),
+            static_cast<float>(camera.x + camera.w), static_cast<float>(camera.y + camera.h) };
+        grid.QuerySolids(view, solids);
+
+        SDL_SetRenderDrawColor(renderer, 255, 128, 0, 255);
+        for (const auto& solid : solids) {
+            SDL_Rect box = {
+                static_cast<int>(solid.box.minX - camera.x),
+                static_cast<int>(solid.box.minY - camera.y),
+                static_cast<int>(solid.box.maxX - solid.box.minX),
+                static_cast<int>(solid.box.maxY - solid.box.minY)
+            };
+            SDL_RenderDrawRect(renderer, &box);
+        }
+        RenderStats::CountDraw(static_cast<int>(solids.size()));
+    }
+};
+
+#endif // TILECOLLISIONSYSTEM_HPP
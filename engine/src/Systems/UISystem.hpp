@@ -21,6 +21,7 @@
 #include "../ECS/ECS.hpp"
 #include "../EventManager/EventManager.hpp"
 #include "../Events/ClickEvent.hpp"
+#include "../Profiler/Profiler.hpp"
 
  /**
   * @brief Represents the system that handles user interface interactions.
@@ -29,6 +30,9 @@
   * actions when they are clicked by the user.
   */
 class UISystem : public System {
+private:
+    EventHandle clickHandle; ///< Subscription to ClickEvent, invalid until subscribed.
+
 public:
     /**
      * @brief Constructs a UISystem.
@@ -48,12 +52,25 @@ public:
      * @param eventManager A unique pointer to the EventManager for managing events.
      *
      * This function registers the UISystem to listen for ClickEvent instances.
+     * The subscription persists across frames and scenes; subscribing again
+     * replaces it.
      */
     void SubscribeToClickEvent(std::unique_ptr<EventManager>& eventManager) {
-        eventManager->SubscribeToEvent<ClickEvent, UISystem>(this,
+        eventManager->Unsubscribe(clickHandle);
+        clickHandle = eventManager->SubscribeToEvent<ClickEvent, UISystem>(this,
             &UISystem::OnClickEvent);
     }
 
+    /**
+     * @brief Stops listening for click events.
+     *
+     * @param eventManager The EventManager the system subscribed to.
+     */
+    void UnsubscribeFromClickEvent(std::unique_ptr<EventManager>& eventManager) {
+        eventManager->Unsubscribe(clickHandle);
+        clickHandle = EventHandle();
+    }
+
     /**
      * @brief Handles click events and triggers associated actions.
      *
@@ -74,6 +91,7 @@ public:
                 if (entity.HasComponent<ScriptComponent>()) {
                     const auto& script = entity.GetComponent<ScriptComponent>();
                     if (script.onClick != sol::nil) {
+                        PROFILE_SCOPE("Lua::on_click");
                         script.onClick();
                     }
                 }
@@ -14,6 +14,8 @@
 #include "../Components/VideoComponent.hpp"
 #include "../Components/TransformComponent.hpp"
 #include "../ECS/ECS.hpp"
+#include "../Profiler/Profiler.hpp"
+#include "../Utils/RenderStats.hpp"
 #include <iostream>
 
  // Video
@@ -85,6 +87,7 @@ public:
      * @param AssetManager Unique pointer to the AssetManager for managing video assets.
      */
     void Update(SDL_Renderer* renderer, SDL_Rect& camera, const std::unique_ptr<AssetManager>& AssetManager) {
+        PROFILE_SCOPE("VideoSystem::Update");
         for (auto entity : GetSystemEntities()) {
             const auto videoComponent = entity.GetComponent<VideoComponent>();
 
@@ -202,6 +205,7 @@ private:
                                 swsCtx, frame->data, frame->linesize, 0, videoAsset.codecCtx->height,
                                 yuvFrame->data, yuvFrame->linesize);
 
+                            RenderStats::CountUpload();
                             SDL_UpdateYUVTexture(
                                 videoAsset.texture, NULL,
                                 yuvFrame->data[0], yuvFrame->linesize[0],
@@ -223,6 +227,7 @@ private:
         }
 
         // Render even if no new frames (for synchronization).
+        RenderStats::CountDraw();
 
         if (transformComponent.cameraFree) {
             SDL_Rect dstRect = { videoComponent.posX, videoComponent.posY,
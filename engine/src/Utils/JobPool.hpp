@@ -0,0 +1,214 @@
+/**
+ * @file JobPool.hpp
+ * @brief Persistent worker thread pool used to split per-frame work across cores
+ * @author Juan Torres
+ * @date 2024
+ */
+
+#ifndef JOBPOOL_HPP
+#define JOBPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Profiler/Profiler.hpp"
+
+/**
+ * @defgroup JobPool JobPool
+ * @{
+ * @brief Runs data-parallel loops on a fixed set of worker threads
+ *
+ * Work is split in contiguous chunks. Every chunk receives its own index so
+ * callers can write results into per-chunk buffers and concatenate them in
+ * chunk order afterwards, which keeps the output identical to a serial run
+ * regardless of how many threads are available.
+ */
+
+/**
+ * @brief Singleton pool of worker threads created once at startup.
+ *
+ * The calling thread takes part in every ParallelFor, so a machine with a
+ * single core runs the same chunks serially without any thread handoff.
+ * ParallelFor must not be called from inside a running task.
+ */
+class JobPool {
+private:
+    /** @brief Signature of a task: chunk index, first item, one past last item */
+    typedef std::function<void(int, int, int)> Task;
+
+    std::vector<std::thread> workers; /**< Worker threads (caller not included) */
+    std::mutex mutex; /**< Guards the task description and counters */
+    std::condition_variable workReady; /**< Signals workers that a new task exists */
+    std::condition_variable workDone; /**< Signals the caller that workers finished */
+
+    const Task* task = nullptr; /**< Task currently being executed */
+    int taskCount = 0; /**< Number of items in the current task */
+    int chunkSize = 0; /**< Items per chunk in the current task */
+    int chunkCount = 0; /**< Number of chunks in the current task */
+    std::atomic<int> nextChunk{ 0 }; /**< Next chunk to be claimed */
+    int activeWorkers = 0; /**< Workers that have not finished the current task */
+    unsigned long generation = 0; /**< Incremented once per submitted task */
+    bool isStopping = false; /**< Set when the pool is being destroyed */
+
+    /**
+     * @brief Starts one worker per extra hardware thread.
+     */
+    JobPool() {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        unsigned int workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+        for (unsigned int i = 0; i < workerCount; i++) {
+            workers.emplace_back(&JobPool::WorkerLoop, this);
+        }
+    }
+
+    /**
+     * @brief Stops and joins all workers.
+     */
+    ~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopping = true;
+        }
+        workReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /**
+     * @brief Claims and runs chunks of the current task until none are left.
+     */
+    void RunChunks() {
+        while (true) {
+            int chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) {
+                return;
+            }
+            int begin = chunk * chunkSize;
+            int end = std::min(begin + chunkSize, taskCount);
+            PROFILE_SCOPE("JobPool::Chunk");
+            (*task)(chunk, begin, end);
+        }
+    }
+
+    /**
+     * @brief Main loop of every worker thread.
+     */
+    void WorkerLoop() {
+        unsigned long seenGeneration = 0;
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [&]() {
+                return isStopping || generation != seenGeneration;
+            });
+            if (isStopping) {
+                return;
+            }
+            seenGeneration = generation;
+            lock.unlock();
+
+            RunChunks();
+
+            lock.lock();
+            if (--activeWorkers == 0) {
+                workDone.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief Computes the chunk size used for a given number of items.
+     * @param count Number of items to process
+     * @param grain Minimum number of items per chunk
+     */
+    int GetChunkSize(int count, int grain) const {
+        int threads = GetThreadCount();
+        int perThread = (count + threads * 4 - 1) / (threads * 4);
+        return std::max(std::max(grain, 1), perThread);
+    }
+
+public:
+    JobPool(const JobPool&) = delete;
+    JobPool& operator=(const JobPool&) = delete;
+
+    /**
+     * @brief Gets the process wide pool.
+     * @return Reference to the JobPool instance
+     */
+    static JobPool& GetInstance() {
+        static JobPool pool;
+        return pool;
+    }
+
+    /**
+     * @brief Gets the number of threads that run tasks, including the caller.
+     */
+    int GetThreadCount() const {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    /**
+     * @brief Gets how many chunks ParallelFor will create for a loop.
+     *
+     * Lets callers size their per-chunk output buffers before the loop runs.
+     *
+     * @param count Number of items to process
+     * @param grain Minimum number of items per chunk
+     */
+    int GetChunkCount(int count, int grain) const {
+        if (count <= 0) {
+            return 0;
+        }
+        int size = GetChunkSize(count, grain);
+        return (count + size - 1) / size;
+    }
+
+    /**
+     * @brief Runs fn over [0, count) split in contiguous chunks.
+     *
+     * Blocks until every chunk has been processed.
+     *
+     * @param count Number of items to process
+     * @param grain Minimum number of items per chunk
+     * @param fn Task called as fn(chunkIndex, begin, end)
+     */
+    void ParallelFor(int count, int grain, const Task& fn) {
+        int chunks = GetChunkCount(count, grain);
+        int size = GetChunkSize(count, grain);
+
+        if (workers.empty() || chunks <= 1) {
+            for (int chunk = 0; chunk < chunks; chunk++) {
+                PROFILE_SCOPE("JobPool::Chunk");
+                fn(chunk, chunk * size, std::min(chunk * size + size, count));
+            }
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            taskCount = count;
+            chunkSize = size;
+            chunkCount = chunks;
+            nextChunk = 0;
+            activeWorkers = static_cast<int>(workers.size());
+            generation++;
+        }
+        workReady.notify_all();
+
+        RunChunks();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        workDone.wait(lock, [&]() { return activeWorkers == 0; });
+        task = nullptr;
+    }
+};
+
+/** @} */ // end of JobPool group
+
+#endif // JOBPOOL_HPP
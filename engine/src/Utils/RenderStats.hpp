@@ -0,0 +1,40 @@
+/**
+ * @file RenderStats.hpp
+ * @brief Per frame counters of draw calls and texture uploads
+ * @author Juan Torres
+ * @date 2024
+ */
+
+#ifndef RENDERSTATS_HPP
+#define RENDERSTATS_HPP
+
+/**
+ * @brief Counts the renderer work of the current frame.
+ *
+ * Every SDL draw and texture upload in the engine bumps one of these
+ * counters; Game::render resets them at the start of the frame and the
+ * PerformanceHud reads them before drawing itself. Only the main
+ * thread renders, so the counters are plain integers.
+ */
+struct RenderStats {
+    static inline int drawCalls = 0; /**< SDL draw and copy calls this frame */
+    static inline int textureUploads = 0; /**< Textures created or updated this frame */
+
+    /** @brief Counts draw calls */
+    static void CountDraw(int calls = 1) {
+        drawCalls += calls;
+    }
+
+    /** @brief Counts texture creations or updates */
+    static void CountUpload(int uploads = 1) {
+        textureUploads += uploads;
+    }
+
+    /** @brief Starts a new frame */
+    static void Reset() {
+        drawCalls = 0;
+        textureUploads = 0;
+    }
+};
+
+#endif // RENDERSTATS_HPP
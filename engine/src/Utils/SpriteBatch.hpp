@@ -0,0 +1,136 @@
+/**
+ * @file SpriteBatch.hpp
+ * @brief Collects textured quads and submits them with SDL_RenderGeometry
+ * @author Juan Torres
+ * @date 2024
+ */
+
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <SDL2/SDL.h>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "RenderStats.hpp"
+
+/**
+ * @brief Draws runs of sprites sharing a texture with one call.
+ *
+ * Every Draw appends the four corners of a quad, already rotated and
+ * flipped, to a vertex array. The batch is submitted with a single
+ * SDL_RenderGeometry call when a sprite uses another texture or on Flush,
+ * so sprites are drawn in the order they were given and a tile layer
+ * sharing one tileset costs one draw call. Index data follows the same
+ * pattern for every quad, so it is written once and only grows.
+ */
+class SpriteBatch {
+private:
+    std::vector<SDL_Vertex> vertices; /**< Corners of the pending quads */
+    std::vector<int> indices; /**< Two triangles per quad, for the most quads seen */
+    SDL_Texture* texture = nullptr; /**< Texture of the pending quads */
+    float invWidth = 1.0f; /**< Inverse width of the texture, maps pixels to texture coordinates */
+    float invHeight = 1.0f; /**< Inverse height of the texture */
+
+    /**
+     * @brief Writes the indices of quads up to a count.
+     */
+    void GrowIndices(size_t quads) {
+        for (size_t quad = indices.size() / 6; quad < quads; quad++) {
+            int first = static_cast<int>(quad * 4);
+            indices.insert(indices.end(), { first, first + 1, first + 2, first + 2, first + 3, first });
+        }
+    }
+
+public:
+    /**
+     * @brief Queues a sprite, submitting the pending quads first if the texture changes.
+     *
+     * Matches SDL_RenderCopyEx with a NULL center: the quad turns around the
+     * center of dstRect, clockwise in degrees, and a flip mirrors the source.
+     *
+     * @param renderer Renderer the batch is drawn with.
+     * @param spriteTexture Texture of the sprite, sprites without one are skipped.
+     * @param srcRect Area of the texture in pixels.
+     * @param dstRect Area of the screen in pixels before the rotation.
+     * @param angle Rotation in degrees.
+     * @param flip True to mirror the sprite horizontally.
+     */
+    void Draw(SDL_Renderer* renderer, SDL_Texture* spriteTexture, const SDL_Rect& srcRect,
+        const SDL_Rect& dstRect, double angle, bool flip) {
+        if (spriteTexture == nullptr) {
+            return;
+        }
+        if (spriteTexture != texture) {
+            Flush(renderer);
+            texture = spriteTexture;
+            int width = 1;
+            int height = 1;
+            SDL_QueryTexture(texture, NULL, NULL, &width, &height);
+            invWidth = 1.0f / static_cast<float>(width > 0 ? width : 1);
+            invHeight = 1.0f / static_cast<float>(height > 0 ? height : 1);
+        }
+
+        float u0 = srcRect.x * invWidth;
+        float v0 = srcRect.y * invHeight;
+        float u1 = (srcRect.x + srcRect.w) * invWidth;
+        float v1 = (srcRect.y + srcRect.h) * invHeight;
+        if (flip) {
+            std::swap(u0, u1);
+        }
+
+        // Corners relative to the center: top left, top right, bottom right, bottom left
+        float halfWidth = dstRect.w * 0.5f;
+        float halfHeight = dstRect.h * 0.5f;
+        float centerX = dstRect.x + halfWidth;
+        float centerY = dstRect.y + halfHeight;
+        const float cornerX[4] = { -halfWidth, halfWidth, halfWidth, -halfWidth };
+        const float cornerY[4] = { -halfHeight, -halfHeight, halfHeight, halfHeight };
+        const float cornerU[4] = { u0, u1, u1, u0 };
+        const float cornerV[4] = { v0, v0, v1, v1 };
+
+        float cosine = 1.0f;
+        float sine = 0.0f;
+        if (angle != 0.0) {
+            double radians = angle * M_PI / 180.0;
+            cosine = static_cast<float>(std::cos(radians));
+            sine = static_cast<float>(std::sin(radians));
+        }
+
+        const SDL_Color white = { 255, 255, 255, 255 };
+        for (int i = 0; i < 4; i++) {
+            SDL_Vertex vertex;
+            vertex.position.x = centerX + cornerX[i] * cosine - cornerY[i] * sine;
+            vertex.position.y = centerY + cornerX[i] * sine + cornerY[i] * cosine;
+            vertex.color = white;
+            vertex.tex_coord.x = cornerU[i];
+            vertex.tex_coord.y = cornerV[i];
+            vertices.push_back(vertex);
+        }
+    }
+
+    /**
+     * @brief Submits the pending quads; call before anything else is drawn.
+     */
+    void Flush(SDL_Renderer* renderer) {
+        if (vertices.empty()) {
+            return;
+        }
+        size_t quads = vertices.size() / 4;
+        GrowIndices(quads);
+        RenderStats::CountDraw();
+        SDL_RenderGeometry(renderer, texture, vertices.data(), static_cast<int>(vertices.size()),
+            indices.data(), static_cast<int>(quads * 6));
+        vertices.clear();
+    }
+
+    /**
+     * @brief Forgets the current texture, for when textures may have been destroyed.
+     */
+    void Reset() {
+        vertices.clear();
+        texture = nullptr;
+    }
+};
+
+#endif // SPRITEBATCH_HPP
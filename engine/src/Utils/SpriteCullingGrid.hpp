@@ -0,0 +1,262 @@
+/**
+ * @file SpriteCullingGrid.hpp
+ * @brief Uniform grid of sprite bounds used to find the sprites in view
+ * @author Juan Torres
+ * @date 2024
+ */
+
+#ifndef SPRITECULLINGGRID_HPP
+#define SPRITECULLINGGRID_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "../Physics/BroadphaseGrid.hpp"
+
+/**
+ * @brief Finds the sprites overlapping a rectangle without visiting the others.
+ *
+ * Items are added with their world bounds and an order value, then Build
+ * sorts them into the cells of a uniform grid stored as one flat array with
+ * an offset per cell. A query walks the cells under the rectangle and
+ * returns the order values of the items that overlap it, so its cost
+ * depends on what is in view rather than on the size of the map. Items
+ * covering too many cells are kept apart and always tested.
+ *
+ * The grid does not follow its items: it is meant for sprites that do not
+ * move and is rebuilt when the set of sprites changes.
+ */
+class SpriteCullingGrid {
+private:
+    /** @brief Starting side of a cell in pixels */
+    static constexpr float CELL_SIZE = 256.0f;
+
+    /** @brief Cells above which the cell size is doubled */
+    static constexpr long long MAX_CELLS = 1 << 20;
+
+    /** @brief Items above this many cells are oversized */
+    static constexpr int MAX_CELLS_PER_ITEM = 64;
+
+    /** @brief Sprite registered in the grid */
+    struct Item {
+        Aabb bounds; /**< World bounds */
+        int order; /**< Value returned by Query */
+    };
+
+    std::vector<Item> items; /**< Every item added since Clear */
+    std::vector<int> oversized; /**< Items kept out of the cells */
+    std::vector<int> cellStart; /**< Offset of every cell in cellItems, plus the end */
+    std::vector<int> cellItems; /**< Items of every cell, cell after cell */
+    std::vector<unsigned int> stamps; /**< Query in which each item was last seen */
+    unsigned int stamp = 0; /**< Current query */
+    float cellSize = CELL_SIZE; /**< Side of a cell in pixels */
+    float originX = 0.0f; /**< Left edge of the first column */
+    float originY = 0.0f; /**< Top edge of the first row */
+    int columns = 0; /**< Cells per row */
+    int rows = 0; /**< Cells per column */
+
+    /**
+     * @brief Gets the cell column or row of a coordinate, clamped to the grid.
+     *
+     * Clamps in float, the cast is undefined for NaN and past the int range.
+     */
+    static int CellIndex(float value, float origin, float size, int count) {
+        float index = std::floor((value - origin) / size);
+        if (std::isnan(index)) {
+            return 0;
+        }
+        return static_cast<int>(std::max(0.0f, std::min(static_cast<float>(count - 1), index)));
+    }
+
+    /**
+     * @brief Tells whether every edge of some bounds is finite.
+     */
+    static bool IsFinite(const Aabb& bounds) {
+        return std::isfinite(bounds.minX) && std::isfinite(bounds.minY)
+            && std::isfinite(bounds.maxX) && std::isfinite(bounds.maxY);
+    }
+
+    /**
+     * @brief Tells whether two bounds overlap.
+     */
+    static bool Overlaps(const Aabb& a, const Aabb& b) {
+        return a.minX < b.maxX && b.minX < a.maxX && a.minY < b.maxY && b.minY < a.maxY;
+    }
+
+public:
+    /**
+     * @brief Removes every item, keeping the allocations.
+     */
+    void Clear() {
+        items.clear();
+        oversized.clear();
+        cellStart.clear();
+        cellItems.clear();
+        columns = 0;
+        rows = 0;
+    }
+
+    /**
+     * @brief Adds an item; it is found by queries after the next Build.
+     * @param bounds World bounds of the sprite.
+     * @param order Value returned by Query for it, e.g. its draw position.
+     */
+    void Add(const Aabb& bounds, int order) {
+        items.push_back({ bounds, order });
+    }
+
+    /**
+     * @brief Sorts the items into the cells covering their bounds.
+     */
+    void Build() {
+        oversized.clear();
+        cellStart.clear();
+        cellItems.clear();
+        stamps.assign(items.size(), 0);
+        stamp = 0;
+        if (items.empty()) {
+            columns = 0;
+            rows = 0;
+            return;
+        }
+
+        // Sprites with infinite or NaN bounds stay out of the cells and the extent
+        bool hasExtent = false;
+        Aabb extent = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (size_t i = 0; i < items.size(); i++) {
+            const Aabb& bounds = items[i].bounds;
+            if (!IsFinite(bounds)) {
+                oversized.push_back(static_cast<int>(i));
+                continue;
+            }
+            if (!hasExtent) {
+                extent = bounds;
+                hasExtent = true;
+            }
+            extent.minX = std::min(extent.minX, bounds.minX);
+            extent.minY = std::min(extent.minY, bounds.minY);
+            extent.maxX = std::max(extent.maxX, bounds.maxX);
+            extent.maxY = std::max(extent.maxY, bounds.maxY);
+        }
+        if (!hasExtent) {
+            columns = 0;
+            rows = 0;
+            return;
+        }
+        originX = extent.minX;
+        originY = extent.minY;
+        cellSize = CELL_SIZE;
+        // In double, the span of two finite floats can overflow a float
+        double spanX = static_cast<double>(extent.maxX) - originX;
+        double spanY = static_cast<double>(extent.maxY) - originY;
+        while (true) {
+            double cellColumns = std::floor(spanX / cellSize) + 1.0;
+            double cellRows = std::floor(spanY / cellSize) + 1.0;
+            if (cellColumns * cellRows <= static_cast<double>(MAX_CELLS)) {
+                columns = static_cast<int>(cellColumns);
+                rows = static_cast<int>(cellRows);
+                break;
+            }
+            cellSize *= 2.0f;
+        }
+
+        // Count the items of every cell, then place them with the running offsets
+        cellStart.assign(static_cast<size_t>(columns) * rows + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            if (pass == 1) {
+                int total = 0;
+                for (auto& start : cellStart) {
+                    int count = start;
+                    start = total;
+                    total += count;
+                }
+                cellItems.resize(total);
+            }
+            for (size_t i = 0; i < items.size(); i++) {
+                const Aabb& bounds = items[i].bounds;
+                if (!IsFinite(bounds)) {
+                    continue;
+                }
+                int minX = CellIndex(bounds.minX, originX, cellSize, columns);
+                int minY = CellIndex(bounds.minY, originY, cellSize, rows);
+                int maxX = CellIndex(bounds.maxX, originX, cellSize, columns);
+                int maxY = CellIndex(bounds.maxY, originY, cellSize, rows);
+                if ((maxX - minX + 1) * (maxY - minY + 1) > MAX_CELLS_PER_ITEM) {
+                    if (pass == 0) {
+                        oversized.push_back(static_cast<int>(i));
+                    }
+                    continue;
+                }
+                for (int y = minY; y <= maxY; y++) {
+                    for (int x = minX; x <= maxX; x++) {
+                        size_t cell = static_cast<size_t>(y) * columns + x;
+                        if (pass == 0) {
+                            cellStart[cell]++;
+                        }
+                        else {
+                            cellItems[cellStart[cell]++] = static_cast<int>(i);
+                        }
+                    }
+                }
+            }
+        }
+
+        // The second pass moved every offset to the start of the next cell
+        for (size_t cell = cellStart.size() - 1; cell > 0; cell--) {
+            cellStart[cell] = cellStart[cell - 1];
+        }
+        cellStart[0] = 0;
+    }
+
+    /**
+     * @brief Appends the order values of the items overlapping a rectangle.
+     * @param view World rectangle, usually the camera with a margin.
+     * @param orders Output values, in no particular order.
+     */
+    void Query(const Aabb& view, std::vector<int>& orders) {
+        if (++stamp == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            stamp = 1;
+        }
+
+        for (int index : oversized) {
+            if (Overlaps(items[index].bounds, view)) {
+                orders.push_back(items[index].order);
+            }
+        }
+        if (columns == 0 || view.maxX < originX || view.maxY < originY
+            || view.minX > originX + columns * cellSize || view.minY > originY + rows * cellSize) {
+            return;
+        }
+
+        int minX = CellIndex(view.minX, originX, cellSize, columns);
+        int minY = CellIndex(view.minY, originY, cellSize, rows);
+        int maxX = CellIndex(view.maxX, originX, cellSize, columns);
+        int maxY = CellIndex(view.maxY, originY, cellSize, rows);
+        for (int y = minY; y <= maxY; y++) {
+            for (int x = minX; x <= maxX; x++) {
+                size_t cell = static_cast<size_t>(y) * columns + x;
+                for (int i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    int index = cellItems[i];
+                    // Items spanning several cells are only reported once
+                    if (stamps[index] == stamp) {
+                        continue;
+                    }
+                    stamps[index] = stamp;
+                    if (Overlaps(items[index].bounds, view)) {
+                        orders.push_back(items[index].order);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Gets the number of items added since Clear.
+     */
+    size_t Size() const {
+        return items.size();
+    }
+};
+
+#endif // SPRITECULLINGGRID_HPP
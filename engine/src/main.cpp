@@ -9,8 +9,11 @@
  * initialization, execution, and cleanup phases using the Game singleton.
  */
 
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include "Game/Game.hpp"
+#include "Profiler/Profiler.hpp"
 
  /**
   * @brief Program entry point
@@ -19,18 +22,79 @@
   * before program termination. Uses the Game singleton pattern to manage
   * the game instance.
   *
+  * Command line options:
+  * - --headless: run without window, renderer and audio
+  * - --frames N: quit after N frames, used with --headless
+  * - --record FILE: save the input of every frame to FILE
+  * - --replay FILE: play back the input saved in FILE with fixed steps
+  * - --trace FILE: write the profiler events as a Chrome trace on exit,
+  *   needs a build with ENABLE_PROFILER (make profile)
+  * - --scene FILE: run the scene in FILE instead of the first scene of
+  *   assets/scripts/scenes.lua
+  * - --stats-json FILE: write the load time, frame times, peak memory and
+  *   per system times of the scene to FILE when it ends
+  *
   * @return int Returns 0 on successful execution
   */
 int main(int argc, char* argv[]) {
-    // Suppress unused parameter warnings
-    (void)argc;
-    (void)argv;
+    bool isHeadless = false;
+    int frames = 0;
+    std::string recordPath;
+    std::string replayPath;
+    std::string tracePath;
+    std::string scenePath;
+    std::string statsPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            isHeadless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        }
+        else if (arg == "--scene" && i + 1 < argc) {
+            scenePath = argv[++i];
+        }
+        else if (arg == "--stats-json" && i + 1 < argc) {
+            statsPath = argv[++i];
+        }
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+        }
+    }
 
     std::cout << "Videogame" << std::endl;
 
     // Get the singleton instance of the game
     Game& game = Game::GetInstance();
 
+    if (isHeadless) {
+        game.SetHeadless(frames);
+    }
+    if (!scenePath.empty()) {
+        game.SetScene(scenePath);
+    }
+    if (!statsPath.empty()) {
+        game.SetStatsPath(statsPath);
+    }
+
+    // Replaying takes precedence, a replay is not recorded again
+    if (!replayPath.empty()) {
+        game.inputRecorder->StartReplay(replayPath);
+    }
+    else if (!recordPath.empty()) {
+        game.inputRecorder->StartRecording(recordPath);
+    }
+
     // Initialize game systems
     game.init();
 
@@ -40,5 +104,13 @@ int main(int argc, char* argv[]) {
     // Cleanup and shutdown
     game.destroy();
 
+    if (!tracePath.empty()) {
+#ifdef ENABLE_PROFILER
+        Profiler::GetInstance().WriteChromeTrace(tracePath);
+#else
+        std::cerr << "[PROFILER] Built without ENABLE_PROFILER, run make profile to use --trace" << std::endl;
+#endif
+    }
+
     return 0;
 }
\ No newline at end of file